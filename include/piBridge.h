@@ -0,0 +1,28 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef PIBRIDGE_H_
+#define PIBRIDGE_H_
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+
+
+/******************************************************************************/
+/*******************************  Prototypes  *********************************/
+/******************************************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int piBridgeProfile(unsigned int seconds, uint32_t period_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PIBRIDGE_H_ */
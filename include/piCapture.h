@@ -0,0 +1,132 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef PICAPTURE_H_
+#define PICAPTURE_H_
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "piImage.h"
+
+
+/******************************************************************************/
+/*********************************  Types  ************************************/
+/******************************************************************************/
+
+/*
+ * Layout of a capture, written with --format cap:
+ *
+ *   header as of a recording, see piFormat.h, with the magic PI_CAP_MAGIC
+ *   and the keyframe interval in ms in the reserved field
+ *   records
+ *   end record
+ *
+ * A record starts with its type byte and the size of the rest of the
+ * record as varint (7 bits per byte, least significant first, high bit
+ * set if more bytes follow). Integers of fixed size are little endian.
+ *
+ *   PI_CAP_KEYFRAME	u64 timestamp, all recorded bytes
+ *   PI_CAP_DELTA	varint ns since the previous sample, then pairs of
+ *			varint unchanged bytes, varint n, n bytes XOR the
+ *			previous sample
+ *   PI_CAP_INDEX	u64 position of the previous index record, 0 if
+ *			none, u32 count, count times u64 timestamp and u64
+ *			position of a keyframe
+ *   PI_CAP_END		u64 position of the last index record, u64 number of
+ *			samples, magic PI_CAP_END_MAGIC; fixed size, so it
+ *			can be read from the end of the file
+ *
+ * Timestamps are in ns since the epoch. An index record lists the
+ * keyframes written since the previous one. A capture without end record,
+ * e.g. after a power loss, is indexed by scanning the record headers.
+ */
+#define PI_CAP_MAGIC		"PICAP\0\0\0"
+#define PI_CAP_END_MAGIC	"PICAPEND"
+#define PI_CAP_VERSION		1
+
+#define PI_CAP_KEYFRAME		'K'
+#define PI_CAP_DELTA		'D'
+#define PI_CAP_INDEX		'I'
+#define PI_CAP_END		'E'
+
+#define PI_CAP_END_SIZE		26	/* type, size and payload */
+#define PI_CAP_KEYFRAME_MS	1000	/* time between keyframes */
+#define PI_CAP_INDEX_ENTRIES	256	/* keyframes per index record */
+
+struct pi_cap_index {
+	uint64_t timestamp;
+	uint64_t pos;			/* file offset of the keyframe */
+};
+
+/* A capture mapped for decoding */
+struct pi_cap {
+	const uint8_t *map;
+	size_t size;
+	struct pi_var *vars;
+	unsigned int count;
+	uint32_t offset;		/* captured bytes of the process image */
+	uint32_t length;
+	uint64_t samples;		/* 0 if unknown */
+	struct pi_cap_index *index;
+	uint64_t keyframes;
+	const uint8_t *records;		/* first record */
+	/* decoder position */
+	const uint8_t *next;		/* next record */
+	bool have_frame;		/* a keyframe was decoded */
+	uint32_t lo, hi;		/* decoded bytes of the frame */
+	uint64_t timestamp;		/* of the current sample */
+	uint8_t *frame;			/* current sample */
+};
+
+struct pi_cap_query {
+	const char *path;		/* capture */
+	const char **vars;		/* names of the variables, all if none */
+	unsigned int nvars;
+	const char *from;		/* time range, see piCapQuery(), NULL */
+	const char *to;			/* for the start or end of the capture */
+	int type;			/* output format of the samples */
+	bool aggregate;			/* print statistics instead of samples */
+};
+
+
+/******************************************************************************/
+/*******************************  Prototypes  *********************************/
+/******************************************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int piCapOpen(const char *path, struct pi_cap *cap);
+void piCapClose(struct pi_cap *cap);
+int piCapSeek(struct pi_cap *cap, uint64_t timestamp);
+int piCapNext(struct pi_cap *cap);
+void piCapSetRange(struct pi_cap *cap, uint32_t offset, uint32_t length);
+
+int piCapDecode(const char *path, int type);
+int piCapQuery(const struct pi_cap_query *query);
+
+/* write a varint, p must have room for 10 bytes, returns the bytes written */
+static inline size_t piCapPutVarint(uint8_t *p, uint64_t value)
+{
+	size_t n = 0;
+
+	while (value >= 0x80) {
+		p[n++] = value | 0x80;
+		value >>= 7;
+	}
+	p[n++] = value;
+	return n;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PICAPTURE_H_ */
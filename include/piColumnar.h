@@ -0,0 +1,85 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef PICOLUMNAR_H_
+#define PICOLUMNAR_H_
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+
+#include "piFormat.h"
+
+
+/******************************************************************************/
+/*********************************  Types  ************************************/
+/******************************************************************************/
+
+/*
+ * Layout of a columnar file, all fields little endian:
+ *
+ *   struct pi_col_header
+ *   struct pi_col_entry		per column, the timestamps come first
+ *   column data			each starting at a multiple of PI_COL_ALIGN
+ *
+ * Every column holds one element of width bytes per sample, so a column can
+ * be mapped and indexed directly:
+ *
+ *   PI_COL_RAW		the values
+ *   PI_COL_DICT	dict_size values of 8 bytes, then the index of the
+ *			value in the dictionary, 1 byte per sample
+ *   PI_COL_DELTA	the difference to the value of the previous sample,
+ *			signed, the first sample has the value base + delta
+ */
+#define PI_COL_MAGIC		"PICOL\0\0\0"
+#define PI_COL_VERSION		1
+#define PI_COL_ALIGN		64
+#define PI_COL_DICT_MAX		256
+
+enum pi_col_encoding {
+	PI_COL_RAW,
+	PI_COL_DICT,
+	PI_COL_DELTA,
+};
+
+struct pi_col_header {
+	char magic[8];
+	uint16_t version;
+	uint16_t columns;		/* number of columns including the timestamps */
+	uint32_t reserved;
+	uint64_t samples;
+};
+
+struct pi_col_entry {
+	char name[PI_REC_NAME_LEN];	/* "ts_ns" for the timestamps */
+	uint16_t offset;		/* variable in the process image */
+	uint16_t length;		/* in bits, 64 for the timestamps */
+	uint8_t bit;
+	uint8_t is_signed;
+	uint8_t encoding;		/* enum pi_col_encoding */
+	uint8_t width;			/* bytes per sample */
+	uint32_t dict_size;
+	uint32_t reserved;
+	int64_t base;			/* start value of a delta encoded column */
+	uint64_t data;			/* file offset of the column */
+	uint64_t size;			/* bytes of the column */
+};
+
+
+/******************************************************************************/
+/*******************************  Prototypes  *********************************/
+/******************************************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int piColumnarConvert(const char *recording, const char *output);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PICOLUMNAR_H_ */
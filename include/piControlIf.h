@@ -11,6 +11,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdio.h>
 #include <piControl.h>
 
 
@@ -20,6 +21,46 @@
 
 extern int PiControlHandle_g;
 
+/* one access of a batch, see piControlTransfer() */
+struct pi_io {
+	uint32_t offset;
+	uint32_t length;
+	uint8_t *data;
+	bool write;
+	int result;		/* transferred bytes or negative errno */
+};
+
+/* relay counters of a RO module, see piControlReadROCounters() */
+struct pi_ro_counters {
+	uint8_t address;
+	uint64_t timestamp;	/* wall clock time of the read in ns */
+	uint32_t counter[REVPI_RO_NUM_RELAYS];
+};
+
+/* operations counted by the statistics of driver calls */
+enum pi_stats_op {
+	PI_STATS_READ,
+	PI_STATS_WRITE,
+	PI_STATS_GET_BIT,
+	PI_STATS_SET_BIT,
+	PI_STATS_FIND_VARIABLE,
+	PI_STATS_DEVICE_INFO,
+	PI_STATS_OTHER_IOCTL,
+	PI_STATS_OPS,
+};
+
+/* latency histogram buckets, bucket n counts calls taking [2^n, 2^(n+1)) ns */
+#define PI_STATS_BUCKETS 32
+
+struct pi_stats {
+	uint64_t calls;
+	uint64_t bytes;
+	uint64_t errors;
+	uint64_t total_ns;
+	uint64_t max_ns;
+	uint64_t hist[PI_STATS_BUCKETS];
+};
+
 
 /******************************************************************************/
 /*******************************  Prototypes  *********************************/
@@ -28,17 +69,21 @@ extern int PiControlHandle_g;
 extern "C" {
 #endif
 
+int piControlOpen(void);
 int piControlReset(void);
 int piControlRead(uint32_t Offset, uint32_t Length, uint8_t *pData);
 int piControlWrite(uint32_t Offset, uint32_t Length, uint8_t *pData);
+int piControlTransfer(struct pi_io *ios, unsigned int n);
 int piControlGetDeviceInfo(SDeviceInfo *pDev);
 int piControlGetDeviceInfoList(SDeviceInfo *pDev);
+int piControlGetDeviceList(const SDeviceInfo **list);
 int piControlGetBitValue(SPIValue *pSpiValue);
 int piControlSetBitValue(SPIValue *pSpiValue);
 int piControlGetVariableInfo(SPIVariable *pSpiVariable);
 int piControlFindVariable(const char *name);
 int piControlResetCounter(int address, int bitfield);
 int piControlGetROCounters(int address);
+int piControlReadROCounters(int address, struct pi_ro_counters *counters);
 int piControlWaitForEvent(void);
 int piControlUpdateFirmware(uint32_t addr_p, bool force_update,
 			    int hw_revision);
@@ -48,6 +93,11 @@ int piControlCalibrate(int addr, int channl, int mode, int xval, int yval);
 
 void piControlClose(void);
 
+void piControlStatsEnable(bool enable);
+void piControlStatsGet(enum pi_stats_op op, struct pi_stats *out);
+const char *piControlStatsName(enum pi_stats_op op);
+void piControlStatsPrint(FILE *fp);
+
 #ifdef __cplusplus
 }
 #endif
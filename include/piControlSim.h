@@ -0,0 +1,41 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef PICONTROLSIM_H_
+#define PICONTROLSIM_H_
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <sys/types.h>
+
+
+/******************************************************************************/
+/*********************************  Macros  ***********************************/
+/******************************************************************************/
+
+/* environment variable selecting the simulation and naming its config file */
+#define PICONTROL_SIM_ENV "PICONTROL_SIM"
+
+
+/******************************************************************************/
+/*******************************  Prototypes  *********************************/
+/******************************************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int piSimOpen(const char *config);
+void piSimClose(int fd);
+ssize_t piSimRead(int fd, void *buf, size_t count, off_t offset);
+ssize_t piSimWrite(int fd, const void *buf, size_t count, off_t offset);
+int piSimIoctl(int fd, unsigned long request, void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PICONTROLSIM_H_ */
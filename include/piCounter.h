@@ -0,0 +1,42 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef PICOUNTER_H_
+#define PICOUNTER_H_
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/******************************************************************************/
+/*********************************  Types  ************************************/
+/******************************************************************************/
+
+struct pi_counter_args {
+	uint32_t window_ms;		/* interval of the computed rates */
+	uint32_t period_us;		/* sampling period */
+	bool reset;			/* reset the counters after every window */
+	bool once;			/* stop after the first window */
+	int type;			/* output format, see piFormat.h */
+};
+
+
+/******************************************************************************/
+/*******************************  Prototypes  *********************************/
+/******************************************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int piCounterRun(const struct pi_counter_args *args);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PICOUNTER_H_ */
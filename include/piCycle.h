@@ -0,0 +1,50 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef PICYCLE_H_
+#define PICYCLE_H_
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+
+/******************************************************************************/
+/*********************************  Types  ************************************/
+/******************************************************************************/
+
+/* Timing state of a cyclic mode */
+struct pi_cycle {
+	uint64_t period_ns;
+	struct timespec next;		/* next release time */
+	uint64_t cycles;
+	uint64_t misses;		/* cycles which ended after the next release time */
+	uint64_t latency_max_ns;	/* worst case delay of a wakeup */
+	uint64_t latency_sum_ns;
+};
+
+
+/******************************************************************************/
+/*******************************  Prototypes  *********************************/
+/******************************************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void piCycleSetRealtime(int priority, int cpu);
+void piCycleCatchSignals(void);
+int piCycleStart(struct pi_cycle *cycle, uint32_t period_us);
+bool piCycleWait(struct pi_cycle *cycle);
+bool piCycleStopped(void);
+void piCycleFinish(const struct pi_cycle *cycle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PICYCLE_H_ */
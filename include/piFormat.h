@@ -0,0 +1,159 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef PIFORMAT_H_
+#define PIFORMAT_H_
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "piImage.h"
+#include "piCapture.h"
+
+
+/******************************************************************************/
+/*********************************  Types  ************************************/
+/******************************************************************************/
+
+enum pi_format_type {
+	PI_FORMAT_TEXT,			/* human readable output of piTest */
+	PI_FORMAT_NDJSON,		/* one JSON object per sample */
+	PI_FORMAT_CSV,			/* header line and one line per sample */
+	PI_FORMAT_BIN,			/* recording, see below */
+	PI_FORMAT_CAP,			/* compressed capture, see piCapture.h */
+};
+
+/*
+ * Layout of a binary recording, all fields little endian:
+ *
+ *   struct pi_rec_header
+ *   struct pi_rec_var			count times
+ *   { uint64_t timestamp; uint8_t data[length]; }	per sample
+ *
+ * The timestamp is the wall clock time of the sample in ns since the epoch,
+ * data are the bytes [offset, offset + length) of the process image.
+ */
+#define PI_REC_MAGIC		"PIREC\0\0\0"
+#define PI_REC_VERSION		1
+#define PI_REC_NAME_LEN		32
+
+struct pi_rec_header {
+	char magic[8];
+	uint16_t version;
+	uint16_t count;			/* number of variables */
+	uint32_t offset;		/* recorded bytes of the process image */
+	uint32_t length;
+	uint32_t reserved;
+};
+
+struct pi_rec_var {
+	char name[PI_REC_NAME_LEN];
+	uint16_t offset;		/* byte offset in the process image */
+	uint16_t length;		/* length in bits: 1, 8, 16 or 32 */
+	uint8_t bit;
+	uint8_t is_signed;
+	uint8_t reserved[2];
+};
+
+/* A binary recording or capture mapped for reading */
+struct pi_rec {
+	const uint8_t *map;
+	size_t size;
+	bool capture;			/* written with --format cap */
+	struct pi_var *vars;
+	unsigned int count;
+	uint32_t offset;		/* recorded bytes of the process image */
+	uint32_t length;
+	const uint8_t *records;		/* first sample */
+	uint64_t samples;		/* 0 for a capture */
+};
+
+#define PI_FORMAT_BUFFER	16384
+
+/* Serializer of samples into a fixed buffer, flushed to a file descriptor */
+struct pi_format {
+	enum pi_format_type type;
+	int fd;
+	const struct pi_var *vars;
+	unsigned int count;
+	uint32_t offset;		/* bytes of the process image in a sample */
+	uint32_t length;
+	int64_t wall_offset;		/* wall clock - monotonic clock in ns, 0 if
+					   the timestamps are wall clock already */
+	int error;			/* first error of a write, sticky */
+	uint64_t written;		/* bytes flushed so far */
+	/* state of PI_FORMAT_CAP */
+	uint8_t *prev;			/* previous sample */
+	uint8_t *delta;			/* encoded change record */
+	uint64_t samples;
+	uint64_t prev_timestamp;
+	uint64_t key_timestamp;		/* of the last keyframe */
+	uint64_t index_pos;		/* of the last index record */
+	unsigned int keyframes;		/* keyframes since that index record */
+	struct pi_cap_index index[PI_CAP_INDEX_ENTRIES];
+	unsigned int fields;		/* fields of the current record, see piFormatKey() */
+	size_t used;
+	char buffer[PI_FORMAT_BUFFER];
+};
+
+
+/******************************************************************************/
+/*******************************  Prototypes  *********************************/
+/******************************************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int piFormatType(const char *name);
+int piFormatInit(struct pi_format *fmt, enum pi_format_type type, int fd,
+		 const struct pi_var *vars, unsigned int count);
+int piFormatHeader(struct pi_format *fmt);
+int piFormatSample(struct pi_format *fmt, uint64_t timestamp, const uint8_t *data);
+int piFormatFlush(struct pi_format *fmt);
+int piFormatFinish(struct pi_format *fmt);
+
+int piFormatTextual(int type);
+void piFormatPrintf(struct pi_format *fmt, const char *spec, ...)
+	__attribute__((format(printf, 2, 3)));
+void piFormatName(struct pi_format *fmt, const char *name);
+void piFormatKey(struct pi_format *fmt, const char *name);
+void piFormatString(struct pi_format *fmt, const char *value);
+void piFormatInt(struct pi_format *fmt, int64_t value);
+void piFormatUint(struct pi_format *fmt, uint64_t value);
+void piFormatDouble(struct pi_format *fmt, const char *spec, double value);
+void piFormatBool(struct pi_format *fmt, bool value);
+void piFormatNull(struct pi_format *fmt);
+int piFormatEnd(struct pi_format *fmt);
+
+int piRecOpen(const char *path, struct pi_rec *rec);
+void piRecClose(struct pi_rec *rec);
+
+/* timestamp of a sample of a recording in ns since the epoch */
+static inline uint64_t piRecTimestamp(const struct pi_rec *rec, uint64_t sample)
+{
+	const uint8_t *p = rec->records + sample * (8 + rec->length);
+	uint64_t ts = 0;
+	int i;
+
+	for (i = 7; i >= 0; i--)
+		ts = ts << 8 | p[i];
+	return ts;
+}
+
+/* recorded process image bytes of a sample, starting at rec->offset */
+static inline const uint8_t *piRecData(const struct pi_rec *rec, uint64_t sample)
+{
+	return rec->records + sample * (8 + rec->length) + 8;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PIFORMAT_H_ */
@@ -0,0 +1,120 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef PIIMAGE_H_
+#define PIIMAGE_H_
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <piControl.h>
+
+
+/******************************************************************************/
+/*********************************  Types  ************************************/
+/******************************************************************************/
+
+/* A resolved variable of the process image */
+struct pi_var {
+	char name[sizeof(((SPIVariable *)0)->strVarName)];
+	uint16_t offset;	/* byte offset in the process image */
+	uint16_t length;	/* length in bits: 1, 8, 16 or 32 */
+	uint8_t bit;		/* bit number (0-7) for 1 bit variables */
+	bool is_signed;		/* interpret the value as two's complement */
+};
+
+/* A set of resolved variables, each variable is looked up only once */
+struct pi_var_table {
+	struct pi_var *vars;
+	unsigned int count;
+	unsigned int size;
+};
+
+/* A contiguous region of the process image */
+struct pi_span {
+	uint32_t offset;
+	uint32_t length;
+};
+
+
+/******************************************************************************/
+/*******************************  Prototypes  *********************************/
+/******************************************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int piImageResolve(const char *spec, struct pi_var *var);
+uint32_t piImageVarBytes(const struct pi_var *var);
+
+int piVarTableAdd(struct pi_var_table *table, const char *spec);
+void piVarTableFree(struct pi_var_table *table);
+
+void piSpanInit(struct pi_span *span);
+void piSpanAdd(struct pi_span *span, uint32_t offset, uint32_t length);
+
+uint64_t piImageTimestamp(void);
+uint64_t piImageWallclock(void);
+
+/***********************************************************************************/
+/*!
+ * @brief Extract a value from a buffer
+ *
+ * @param[in]   p		first byte of the value
+ * @param[in]   length		length of the value in bits: 1, 8, 16 or 32
+ * @param[in]   bit		bit number for 1 bit values
+ * @param[in]   is_signed	sign extend the value
+ *
+ * @return the value
+ *
+ ************************************************************************************/
+static inline int64_t piImageExtract(const uint8_t *p, uint16_t length,
+				     uint8_t bit, bool is_signed)
+{
+	uint32_t raw;
+
+	switch (length) {
+	case 1:
+		return (p[0] >> bit) & 1;
+	case 8:
+		raw = p[0];
+		return is_signed ? (int8_t)raw : (int64_t)raw;
+	case 16:
+		raw = p[0] | (p[1] << 8);
+		return is_signed ? (int16_t)raw : (int64_t)raw;
+	default:
+		raw = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+		return is_signed ? (int32_t)raw : (int64_t)raw;
+	}
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Extract the value of a variable from a buffer
+ *
+ * The buffer holds a copy of the process image starting at offset base. The
+ * variable has to be located completely inside the buffer.
+ *
+ * @param[in]   image	buffer with process image data
+ * @param[in]   base	offset of the first byte of the buffer in the process image
+ * @param[in]   var	variable to extract
+ *
+ * @return the value, sign extended if the variable is signed
+ *
+ ************************************************************************************/
+static inline int64_t piImageValue(const uint8_t *image, uint32_t base,
+				   const struct pi_var *var)
+{
+	return piImageExtract(image + (var->offset - base), var->length,
+			      var->bit, var->is_signed);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PIIMAGE_H_ */
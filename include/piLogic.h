@@ -0,0 +1,45 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef PILOGIC_H_
+#define PILOGIC_H_
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "piImage.h"
+
+
+/******************************************************************************/
+/*********************************  Types  ************************************/
+/******************************************************************************/
+
+struct pi_logic;
+
+
+/******************************************************************************/
+/*******************************  Prototypes  *********************************/
+/******************************************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct pi_logic *piLogicCreate(void);
+void piLogicFree(struct pi_logic *logic);
+int piLogicAddRule(struct pi_logic *logic, const char *rule, unsigned int line);
+int piLogicLoad(struct pi_logic *logic, const char *path);
+int piLogicCompile(struct pi_logic *logic);
+int piLogicCycle(struct pi_logic *logic);
+
+int piLogicRun(const char *path, uint32_t period_us, bool cyclic);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PILOGIC_H_ */
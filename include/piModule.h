@@ -0,0 +1,92 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef PIMODULE_H_
+#define PIMODULE_H_
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <piControl.h>
+
+#include "piImage.h"
+#include "piSchema.h"
+
+
+/******************************************************************************/
+/*********************************  Types  ************************************/
+/******************************************************************************/
+
+/*
+ * A field of the input or output block of a module type. Fields with a
+ * count > 1 are channels, the name then contains %u for the channel number
+ * starting at 1 and stride is the distance of the channels, in bits for
+ * bool fields and in bytes otherwise.
+ */
+struct pi_module_field {
+	const char *name;
+	enum pi_schema_type type;
+	uint16_t offset;		/* byte offset in the block */
+	uint8_t bit;			/* first bit of bool and bits fields */
+	uint8_t width;			/* bits of bits fields, 0 for the other types */
+	uint16_t count;
+	uint8_t stride;
+};
+
+/* Layout of the process image of a module type */
+struct pi_module_layout {
+	uint16_t type;			/* i16uModuleType */
+	const struct pi_module_field *inputs;
+	unsigned int ninputs;
+	const struct pi_module_field *outputs;
+	unsigned int noutputs;
+};
+
+/* A module of the device list, decoded with a single read */
+struct pi_module {
+	const SDeviceInfo *dev;
+	uint32_t offset;		/* read region, covering inputs and outputs */
+	uint32_t length;
+	unsigned int first;		/* first field in the schema of the modules */
+	unsigned int count;		/* number of fields */
+};
+
+/* Modules of the device list and the schema of their regions */
+struct pi_modules {
+	struct pi_module *modules;
+	unsigned int count;
+	struct pi_schema schema;	/* offsets relative to span.offset */
+	struct pi_span span;		/* region covering all modules */
+};
+
+struct pi_module_args {
+	const int *addrs;		/* addresses of the modules */
+	unsigned int naddrs;		/* 0 for all modules */
+	uint32_t period_us;		/* sampling period */
+	bool once;			/* stop after the first sample */
+	int type;			/* output format, see piFormat.h */
+};
+
+
+/******************************************************************************/
+/*******************************  Prototypes  *********************************/
+/******************************************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+const struct pi_module_layout *piModuleLayout(uint16_t type);
+int piModulesInit(struct pi_modules *mods, const int *addrs, unsigned int naddrs);
+void piModulesFree(struct pi_modules *mods);
+int piModulesRead(const struct pi_modules *mods, uint8_t *image);
+int piModuleRun(const struct pi_module_args *args);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PIMODULE_H_ */
@@ -0,0 +1,69 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef PIMONITOR_H_
+#define PIMONITOR_H_
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "piImage.h"
+
+
+/******************************************************************************/
+/*********************************  Types  ************************************/
+/******************************************************************************/
+
+enum pi_monitor_kind {
+	PI_MONITOR_RISING,
+	PI_MONITOR_FALLING,
+	PI_MONITOR_EDGE,
+	PI_MONITOR_ABOVE,
+	PI_MONITOR_BELOW,
+	PI_MONITOR_RATE,
+};
+
+/* Event passed to the callback of piMonitorEvaluate() on every transition */
+struct pi_monitor_event {
+	uint64_t timestamp;		/* monotonic timestamp of the sample in ns */
+	unsigned int rule;		/* line of the rule in the rule set */
+	enum pi_monitor_kind kind;
+	const struct pi_var *var;
+	int64_t value;			/* value (or rate per second) that caused the event */
+	bool active;			/* new state of a level rule, direction of an edge */
+};
+
+typedef void (*piMonitorEventFn)(void *ctx, const struct pi_monitor_event *event);
+
+struct pi_monitor;
+
+
+/******************************************************************************/
+/*******************************  Prototypes  *********************************/
+/******************************************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct pi_monitor *piMonitorCreate(void);
+void piMonitorFree(struct pi_monitor *mon);
+int piMonitorAddRule(struct pi_monitor *mon, const char *rule, unsigned int line);
+int piMonitorLoad(struct pi_monitor *mon, const char *path);
+int piMonitorCompile(struct pi_monitor *mon);
+const struct pi_span *piMonitorSpan(const struct pi_monitor *mon);
+int piMonitorEvaluate(struct pi_monitor *mon, const uint8_t *image, uint32_t base,
+		      uint64_t timestamp, piMonitorEventFn fn, void *ctx);
+const char *piMonitorKindName(enum pi_monitor_kind kind);
+
+int piMonitorRun(const char *path, uint32_t period_us, bool cyclic);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PIMONITOR_H_ */
@@ -0,0 +1,39 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef PIRELAY_H_
+#define PIRELAY_H_
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/******************************************************************************/
+/*********************************  Types  ************************************/
+/******************************************************************************/
+
+struct pi_relay_args {
+	const char *state;		/* counters of the previous run, NULL for none */
+	int type;			/* output format, see piFormat.h */
+};
+
+
+/******************************************************************************/
+/*******************************  Prototypes  *********************************/
+/******************************************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int piRelayRun(const struct pi_relay_args *args);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PIRELAY_H_ */
@@ -0,0 +1,47 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef PIRING_H_
+#define PIRING_H_
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+
+
+/******************************************************************************/
+/*********************************  Types  ************************************/
+/******************************************************************************/
+
+/* Single producer single consumer ring of timestamped samples */
+struct pi_ring;
+
+
+/******************************************************************************/
+/*******************************  Prototypes  *********************************/
+/******************************************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct pi_ring *piRingCreate(uint32_t slots, uint32_t sample_size);
+void piRingFree(struct pi_ring *ring);
+
+uint8_t *piRingReserve(struct pi_ring *ring);
+void piRingCommit(struct pi_ring *ring, uint64_t timestamp);
+void piRingClose(struct pi_ring *ring);
+
+const uint8_t *piRingPeek(struct pi_ring *ring, uint64_t *timestamp);
+void piRingRelease(struct pi_ring *ring);
+uint32_t piRingPending(const struct pi_ring *ring);
+
+uint64_t piRingOverflows(const struct pi_ring *ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PIRING_H_ */
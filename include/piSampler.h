@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef PISAMPLER_H_
+#define PISAMPLER_H_
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include "piRing.h"
+
+
+/******************************************************************************/
+/*********************************  Types  ************************************/
+/******************************************************************************/
+
+/* default size of the ring, see piSamplerStart() */
+#define PI_SAMPLER_RING_BYTES		(256 * 1024)
+#define PI_SAMPLER_RING_MIN_SLOTS	16
+
+/* Samples passed through a ring to an output thread */
+struct pi_sampler {
+	/* called by the output thread for every sample */
+	void (*output)(void *ctx, uint64_t timestamp, const uint8_t *sample);
+	/* called by the output thread when no more samples are queued, may be NULL */
+	void (*flush)(void *ctx);
+	void *ctx;
+	struct pi_ring *ring;
+	pthread_t thread;
+};
+
+
+/******************************************************************************/
+/*******************************  Prototypes  *********************************/
+/******************************************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int piSamplerStart(struct pi_sampler *sampler, uint32_t slots, uint32_t sample_size);
+void piSamplerPush(struct pi_sampler *sampler, const uint8_t *sample, uint32_t length,
+		   uint64_t timestamp);
+int piSamplerRead(struct pi_sampler *sampler, uint32_t offset, uint32_t length,
+		  uint32_t period_us);
+void piSamplerStop(struct pi_sampler *sampler);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PISAMPLER_H_ */
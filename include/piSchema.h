@@ -0,0 +1,104 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef PISCHEMA_H_
+#define PISCHEMA_H_
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "piFormat.h"
+#include "piImage.h"
+
+
+/******************************************************************************/
+/*********************************  Types  ************************************/
+/******************************************************************************/
+
+/* bytes a buffer passed to piSchemaDecode() needs after the region */
+#define PI_SCHEMA_PADDING 7
+#define PI_SCHEMA_NAME_LEN 32
+
+enum pi_schema_type {
+	PI_SCHEMA_U8,
+	PI_SCHEMA_S8,
+	PI_SCHEMA_U16,
+	PI_SCHEMA_S16,
+	PI_SCHEMA_U32,
+	PI_SCHEMA_S32,
+	PI_SCHEMA_BOOL,			/* single bit */
+	PI_SCHEMA_BITS,			/* unsigned bitfield of 1 to 32 bits */
+	PI_SCHEMA_F32,			/* IEEE 754 single precision */
+};
+
+/* A typed field of a region, compiled into the parameters of the decoder */
+struct pi_schema_field {
+	char name[PI_SCHEMA_NAME_LEN];
+	enum pi_schema_type type;
+	uint32_t offset;		/* byte offset in the region */
+	uint8_t bit;			/* first bit of BOOL and BITS fields */
+	uint8_t width;			/* number of bits */
+	uint32_t sign;			/* sign bit of signed fields, 0 otherwise */
+	uint64_t mask;			/* mask of the value bits */
+};
+
+/* A decoded value, i for integer types and bools, f for floats */
+struct pi_schema_value {
+	union {
+		int64_t i;
+		double f;
+	};
+};
+
+/* Layout of a region of the process image */
+struct pi_schema {
+	struct pi_schema_field *fields;
+	unsigned int count;
+	unsigned int size;
+	uint32_t length;		/* bytes covered by the fields */
+};
+
+struct pi_schema_args {
+	const char *path;		/* schema, see piSchemaLoad() */
+	uint32_t offset;		/* offset of the region in the process image */
+	uint32_t period_us;		/* sampling period */
+	bool once;			/* stop after the first sample */
+	int type;			/* output format, see piFormat.h */
+};
+
+
+/******************************************************************************/
+/*******************************  Prototypes  *********************************/
+/******************************************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int piSchemaParseType(const char *name, enum pi_schema_type *type, uint8_t *width);
+int piSchemaAdd(struct pi_schema *schema, const char *name, enum pi_schema_type type,
+		uint32_t offset, uint8_t bit, uint8_t width);
+int piSchemaAddVar(struct pi_schema *schema, const struct pi_var *var, uint32_t base);
+int piSchemaLoad(struct pi_schema *schema, const char *path, uint32_t base);
+void piSchemaFree(struct pi_schema *schema);
+
+void piSchemaDecode(const struct pi_schema *schema, const uint8_t *region,
+		    struct pi_schema_value *values);
+int piSchemaFormat(const struct pi_schema_field *field, const struct pi_schema_value *value,
+		   char *buf, size_t size);
+void piSchemaPrintHeader(const struct pi_schema *schema, struct pi_format *fmt);
+void piSchemaPrint(const struct pi_schema *schema, struct pi_format *fmt, uint64_t timestamp,
+		   const struct pi_schema_value *values);
+
+int piSchemaRun(const struct pi_schema_args *args);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PISCHEMA_H_ */
@@ -0,0 +1,46 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef PISCOPE_H_
+#define PISCOPE_H_
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/******************************************************************************/
+/*********************************  Types  ************************************/
+/******************************************************************************/
+
+struct pi_scope_args {
+	unsigned int pre;		/* samples kept before the trigger */
+	unsigned int post;		/* samples written after the trigger */
+	unsigned int nvars;
+	const char **vars;		/* written variables, see piImageResolve() */
+	unsigned int ntriggers;
+	const char **triggers;		/* rules in the syntax of piMonitorAddRule() */
+	uint32_t period_us;		/* sampling period */
+	bool once;			/* stop after the first window */
+	int type;			/* output format, see piFormat.h */
+};
+
+
+/******************************************************************************/
+/*******************************  Prototypes  *********************************/
+/******************************************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int piScopeRun(const struct pi_scope_args *args);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PISCOPE_H_ */
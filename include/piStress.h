@@ -0,0 +1,52 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef PISTRESS_H_
+#define PISTRESS_H_
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/******************************************************************************/
+/*********************************  Types  ************************************/
+/******************************************************************************/
+
+struct pi_contention_args {
+	unsigned int readers;		/* maximum number of reader threads */
+	unsigned int writers;		/* maximum number of writer threads */
+	uint32_t offset;		/* region accessed by the threads */
+	uint32_t length;
+	unsigned int seconds;		/* duration of each step */
+	bool overlap;			/* all threads access the whole region */
+	bool bits;			/* use the bit ioctls instead of read/write */
+};
+
+struct pi_torn_args {
+	unsigned int readers;		/* number of reader threads */
+	unsigned int seconds;		/* duration of the test */
+	unsigned int nvars;
+	const char **vars;		/* 16 or 32 bit variables, see piImageResolve() */
+};
+
+
+/******************************************************************************/
+/*******************************  Prototypes  *********************************/
+/******************************************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int piStressContention(const struct pi_contention_args *args);
+int piStressTorn(const struct pi_torn_args *args);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PISTRESS_H_ */
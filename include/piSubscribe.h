@@ -0,0 +1,77 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef PISUBSCRIBE_H_
+#define PISUBSCRIBE_H_
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "piImage.h"
+
+
+/******************************************************************************/
+/*********************************  Types  ************************************/
+/******************************************************************************/
+
+/* only call back when the data of the subscription changed */
+#define PI_SUBSCRIBE_ON_CHANGE	0x1
+
+/* Event passed to the callback of a subscription */
+struct pi_subscribe_event {
+	uint64_t timestamp;		/* monotonic timestamp of the read in ns */
+	int id;				/* id returned when subscribing */
+	const struct pi_var *var;	/* subscribed variable, NULL for a region,
+					 * valid until the callback returns */
+	int64_t value;			/* value of the variable */
+	uint32_t offset;		/* subscribed bytes of the process image */
+	uint32_t length;
+	const uint8_t *data;		/* current content of these bytes */
+};
+
+typedef void (*piSubscribeFn)(void *ctx, const struct pi_subscribe_event *event);
+
+/* Counters of an event loop */
+struct pi_subscribe_stats {
+	uint64_t cycles;		/* wakeups of the loop */
+	uint64_t reads;			/* reads of the process image */
+	uint64_t bytes;			/* bytes read */
+	uint64_t events;		/* callbacks */
+	uint64_t misses;		/* periods skipped because the loop was late */
+	uint64_t errors;		/* failed reads, their wakeups were skipped */
+};
+
+struct pi_subscribe_loop;
+
+
+/******************************************************************************/
+/*******************************  Prototypes  *********************************/
+/******************************************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct pi_subscribe_loop *piSubscribeCreate(void);
+void piSubscribeFree(struct pi_subscribe_loop *loop);
+int piSubscribeVariable(struct pi_subscribe_loop *loop, const char *spec,
+			uint32_t period_us, unsigned int flags, piSubscribeFn fn, void *ctx);
+int piSubscribeRegion(struct pi_subscribe_loop *loop, uint32_t offset, uint32_t length,
+		      uint32_t period_us, unsigned int flags, piSubscribeFn fn, void *ctx);
+int piUnsubscribe(struct pi_subscribe_loop *loop, int id);
+int piSubscribeRun(struct pi_subscribe_loop *loop);
+void piSubscribeStop(struct pi_subscribe_loop *loop);
+void piSubscribeGetStats(const struct pi_subscribe_loop *loop,
+			 struct pi_subscribe_stats *stats);
+
+int piSubscribeWatch(const char *specs, uint32_t period_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PISUBSCRIBE_H_ */
@@ -0,0 +1,37 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef PITEST_H_
+#define PITEST_H_
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "piFormat.h"
+
+
+/******************************************************************************/
+/*******************************  Prototypes  *********************************/
+/******************************************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+char *getModuleName(uint16_t moduletype);
+int showDeviceList(void);
+int readData(uint16_t offset, uint16_t length, bool cyclic, char format, bool quiet,
+	     uint32_t period_us);
+int readVariableValue(char *pszVariableName, bool cyclic, char format, bool quiet,
+		      uint32_t period_us);
+int readFormatted(const char *spec, bool cyclic, enum pi_format_type type, uint32_t period_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PITEST_H_ */
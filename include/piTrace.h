@@ -0,0 +1,52 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef PITRACE_H_
+#define PITRACE_H_
+
+/*
+ * USDT tracepoints of the provider "piTest", built in with PITEST_TRACE.
+ *
+ * A disabled probe is a single nop. Arguments which are expensive to
+ * compute, like durations, are only computed if PI_TRACE_ENABLED() reports
+ * an attached tracer, which is signalled through a semaphore in the
+ * .probes section. Every probe needs a PI_TRACE_SEMAPHORE() definition in
+ * the translation unit using it. Without PITEST_TRACE all of this compiles
+ * to nothing.
+ *
+ * Example: bpftrace -e 'usdt:/usr/bin/piTest:piTest:ioctl_return { @[arg0] = hist(arg3); }'
+ */
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#ifdef PITEST_TRACE
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+#endif
+
+
+/******************************************************************************/
+/*********************************  Macros  ***********************************/
+/******************************************************************************/
+
+#ifdef PITEST_TRACE
+#define PI_TRACE_SEMAPHORE(name) \
+	__extension__ unsigned short piTest_##name##_semaphore \
+	__attribute__((unused)) __attribute__((section(".probes")))
+#define PI_TRACE_ENABLED(name)		__builtin_expect(piTest_##name##_semaphore, 0)
+#define PI_TRACE2(name, a, b)		DTRACE_PROBE2(piTest, name, a, b)
+#define PI_TRACE4(name, a, b, c, d)	DTRACE_PROBE4(piTest, name, a, b, c, d)
+#else
+#define PI_TRACE_SEMAPHORE(name)	struct pi_trace_unused_##name
+#define PI_TRACE_ENABLED(name)		0
+/* the arguments are referenced, but never evaluated */
+#define PI_TRACE2(name, a, b) \
+	do { if (0) { (void)(a); (void)(b); } } while (0)
+#define PI_TRACE4(name, a, b, c, d) \
+	do { if (0) { (void)(a); (void)(b); (void)(c); (void)(d); } } while (0)
+#endif
+
+#endif /* PITRACE_H_ */
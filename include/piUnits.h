@@ -0,0 +1,65 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef PIUNITS_H_
+#define PIUNITS_H_
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "piImage.h"
+#include "piSchema.h"
+
+
+/******************************************************************************/
+/*********************************  Types  ************************************/
+/******************************************************************************/
+
+#define PI_UNITS_NAME_LEN 16
+
+/*
+ * Scaling table of variables, loaded once. The channels are compiled into a
+ * schema of the span and the scaling parameters are stored as arrays, so a
+ * read of the whole span is converted in two loops without branches. Buffers
+ * passed to piUnitsConvert() need PI_SCHEMA_PADDING bytes after the span.
+ */
+struct pi_units {
+	struct pi_var_table table;	/* the channels, in the order of the file */
+	struct pi_span span;		/* region covering all channels */
+	struct pi_schema schema;	/* raw values of the channels in the span */
+	double *gain;
+	double *offset;
+	char (*unit)[PI_UNITS_NAME_LEN];
+};
+
+struct pi_units_args {
+	const char *path;		/* scaling table, see piUnitsLoad() */
+	uint32_t period_us;		/* sampling period */
+	bool once;			/* stop after the first sample */
+	int type;			/* output format, see piFormat.h */
+};
+
+
+/******************************************************************************/
+/*******************************  Prototypes  *********************************/
+/******************************************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int piUnitsLoad(struct pi_units *units, const char *path);
+void piUnitsFree(struct pi_units *units);
+void piUnitsConvert(const struct pi_units *units, const uint8_t *image,
+		    struct pi_schema_value *raw, double *values);
+int piUnitsRun(const struct pi_units_args *args);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PIUNITS_H_ */
@@ -0,0 +1,35 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef PIURING_H_
+#define PIURING_H_
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "piControlIf.h"
+
+
+/******************************************************************************/
+/*******************************  Prototypes  *********************************/
+/******************************************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int piUringInit(unsigned int entries, void *buffer, size_t size);
+void piUringExit(void);
+bool piUringActive(void);
+int piUringSubmit(struct pi_io *ios, unsigned int n);
+int piUringReap(struct pi_io **done, unsigned int max, bool wait);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PIURING_H_ */
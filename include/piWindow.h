@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef PIWINDOW_H_
+#define PIWINDOW_H_
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/******************************************************************************/
+/*********************************  Types  ************************************/
+/******************************************************************************/
+
+/* Streaming statistics of the values of one window, constant memory */
+struct pi_window_stat {
+	uint64_t count;
+	int64_t min;
+	int64_t max;
+	double mean;			/* running mean (Welford) */
+	double m2;			/* sum of squared differences from the mean */
+	double sumsq;			/* sum of squares, for the RMS */
+};
+
+struct pi_window_args {
+	uint32_t window_ms;		/* length of a window */
+	unsigned int nvars;
+	const char **vars;		/* see piImageResolve() */
+	uint32_t period_us;		/* sampling period */
+	bool once;			/* stop after the first window */
+	int type;			/* output format, see piFormat.h */
+};
+
+
+/******************************************************************************/
+/*******************************  Prototypes  *********************************/
+/******************************************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void piWindowReset(struct pi_window_stat *st);
+double piWindowStddev(const struct pi_window_stat *st);
+double piWindowRms(const struct pi_window_stat *st);
+int piWindowRun(const struct pi_window_args *args);
+
+/* add a value to the statistics of a window */
+static inline void piWindowAdd(struct pi_window_stat *st, int64_t value)
+{
+	double delta = value - st->mean;
+
+	st->count++;
+	st->mean += delta / st->count;
+	st->m2 += delta * (value - st->mean);
+	st->sumsq += (double)value * value;
+	if (value < st->min)
+		st->min = value;
+	if (value > st->max)
+		st->max = value;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PIWINDOW_H_ */
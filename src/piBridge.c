@@ -0,0 +1,232 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+/*!
+ * Project: piTest
+ * Demo source code for usage of piControl driver
+ *
+ * \file piBridge.c
+ *
+ * \brief piBridge cycle time profiler
+ *
+ * The input data of a module is updated once per piBridge cycle. Sampling
+ * the process image much faster than that and recording when the input
+ * bytes of a module change yields intervals which are multiples of the
+ * cycle time. The cluster of the shortest intervals gives the cycle time and
+ * its jitter.
+ */
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "piControlIf.h"
+#include "piBridge.h"
+#include "piCycle.h"
+#include "piImage.h"
+#include "piTest.h"
+
+/******************************************************************************/
+/*********************************  Types  ************************************/
+/******************************************************************************/
+
+struct bridge_module {
+	const SDeviceInfo *dev;
+	uint64_t last_change;		/* timestamp of the last change in ns */
+	uint32_t *intervals;		/* intervals between changes in ns */
+	unsigned int nintervals;
+	unsigned int intervals_size;
+	unsigned long changes;
+};
+
+/******************************************************************************/
+/*******************************  Functions  **********************************/
+/******************************************************************************/
+
+static int add_interval(struct bridge_module *mod, uint64_t interval)
+{
+	if (mod->nintervals == mod->intervals_size) {
+		unsigned int size = mod->intervals_size ? mod->intervals_size * 2 : 1024;
+		uint32_t *intervals = realloc(mod->intervals, size * sizeof(*intervals));
+
+		if (!intervals)
+			return -ENOMEM;
+		mod->intervals = intervals;
+		mod->intervals_size = size;
+	}
+	mod->intervals[mod->nintervals++] = interval > UINT32_MAX ? UINT32_MAX : interval;
+
+	return 0;
+}
+
+static int compare_u32(const void *a, const void *b)
+{
+	uint32_t ia = *(const uint32_t *)a, ib = *(const uint32_t *)b;
+
+	return ia < ib ? -1 : ia > ib;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Estimate and print the cycle time of one module
+ *
+ * The 5th percentile of the intervals is taken as a first estimate, which is
+ * robust against single short intervals. All intervals within half of that
+ * estimate around it form the cluster of single cycles, whose mean and
+ * standard deviation are the cycle time and its jitter.
+ *
+ ************************************************************************************/
+static void report_module(struct bridge_module *mod)
+{
+	double sum = 0, sum_sq = 0, mean, stddev;
+	uint32_t estimate, min = UINT32_MAX, max = 0;
+	unsigned int i, n = 0;
+
+	printf("Address: %d %s: ", mod->dev->i8uAddress,
+	       getModuleName(mod->dev->i16uModuleType & PICONTROL_NOT_CONNECTED_MASK));
+
+	if (mod->nintervals < 2) {
+		printf("%lu input changes, not enough for an estimate\n", mod->changes);
+		return;
+	}
+
+	qsort(mod->intervals, mod->nintervals, sizeof(*mod->intervals), compare_u32);
+	estimate = mod->intervals[mod->nintervals * 5 / 100];
+
+	for (i = 0; i < mod->nintervals; i++) {
+		uint32_t v = mod->intervals[i];
+
+		if (v < estimate / 2 || v > estimate + estimate / 2)
+			continue;
+		sum += v;
+		sum_sq += (double)v * v;
+		if (v < min)
+			min = v;
+		if (v > max)
+			max = v;
+		n++;
+	}
+
+	mean = sum / n;
+	stddev = sqrt(sum_sq / n - mean * mean > 0 ? sum_sq / n - mean * mean : 0);
+
+	printf("%lu input changes, cycle time %.3f ms, jitter %.3f ms (min %.3f ms, max %.3f ms, %u of %u intervals)\n",
+	       mod->changes, mean / 1e6, stddev / 1e6, min / 1e6, max / 1e6,
+	       n, mod->nintervals);
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Profile the piBridge cycle time
+ *
+ * Reads the input data of all active modules with one read per sample and
+ * estimates the cycle time of every module from the points in time at which
+ * its input data changes. Modules whose inputs do not change, e.g. digital
+ * inputs without any signal change, cannot be profiled.
+ *
+ * @param[in]   seconds		duration of the measurement
+ * @param[in]   period_us	sample period, 0 to sample as fast as possible
+ *
+ * @return 0 on success, < 0 on error
+ *
+ ************************************************************************************/
+int piBridgeProfile(unsigned int seconds, uint32_t period_us)
+{
+	SDeviceInfo asDevList[REV_PI_DEV_CNT_MAX];
+	struct bridge_module mods[REV_PI_DEV_CNT_MAX];
+	struct pi_cycle cycle;
+	struct pi_span span;
+	uint8_t *cur = NULL, *prev = NULL, *tmp;
+	uint64_t start, end, now;
+	unsigned long samples = 0;
+	int devcount, nmods = 0;
+	int i, rc;
+
+	devcount = piControlGetDeviceInfoList(asDevList);
+	if (devcount < 0)
+		return devcount;
+
+	memset(mods, 0, sizeof(mods));
+	piSpanInit(&span);
+	for (i = 0; i < devcount; i++) {
+		if (!asDevList[i].i8uActive || asDevList[i].i16uInputLength == 0)
+			continue;
+		mods[nmods++].dev = &asDevList[i];
+		piSpanAdd(&span, asDevList[i].i16uInputOffset, asDevList[i].i16uInputLength);
+	}
+	if (nmods == 0) {
+		fprintf(stderr, "No active module with inputs found\n");
+		return -ENODEV;
+	}
+
+	cur = malloc(span.length);
+	prev = malloc(span.length);
+	if (!cur || !prev) {
+		fprintf(stderr, "Not enough memory\n");
+		rc = -ENOMEM;
+		goto out;
+	}
+	memset(cur, 0, span.length);
+
+	rc = piCycleStart(&cycle, period_us);
+	if (rc < 0)
+		goto out;
+
+	rc = piControlRead(span.offset, span.length, prev);
+	if (rc < 0)
+		goto out;
+
+	start = piImageTimestamp();
+	end = start + (uint64_t)seconds * 1000000000ULL;
+
+	do {
+		rc = piControlRead(span.offset, span.length, cur);
+		if (rc < 0)
+			goto out;
+		now = piImageTimestamp();
+		samples++;
+
+		for (i = 0; i < nmods; i++) {
+			struct bridge_module *mod = &mods[i];
+			uint32_t pos = mod->dev->i16uInputOffset - span.offset;
+
+			if (!memcmp(cur + pos, prev + pos, mod->dev->i16uInputLength))
+				continue;
+			if (mod->changes++ && add_interval(mod, now - mod->last_change) < 0) {
+				fprintf(stderr, "Not enough memory\n");
+				rc = -ENOMEM;
+				goto out;
+			}
+			mod->last_change = now;
+		}
+
+		tmp = prev;
+		prev = cur;
+		cur = tmp;
+
+		if (period_us ? !piCycleWait(&cycle) : piCycleStopped())
+			break;
+	} while (now < end);
+
+	piCycleFinish(&cycle);
+
+	printf("%lu samples in %.3f s, mean sample period %.3f ms\n\n", samples,
+	       (now - start) / 1e9, samples ? (now - start) / 1e6 / samples : 0.0);
+	for (i = 0; i < nmods; i++)
+		report_module(&mods[i]);
+	rc = 0;
+
+out:
+	for (i = 0; i < nmods; i++)
+		free(mods[i].intervals);
+	free(cur);
+	free(prev);
+	return rc;
+}
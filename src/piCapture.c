@@ -0,0 +1,597 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+/*!
+ * Project: piTest
+ * Demo source code for usage of piControl driver
+ *
+ * \file piCapture.c
+ *
+ * \brief Decoder of compressed captures
+ *
+ * A capture, written with --format cap, stores a keyframe with all captured
+ * bytes at least once per PI_CAP_KEYFRAME_MS and in between only the bytes
+ * that changed since the previous sample. The keyframes are listed in index
+ * records, so decoding can start at the keyframe preceding any point in
+ * time. The encoder is part of piFormat.
+ */
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "piCapture.h"
+#include "piFormat.h"
+
+/******************************************************************************/
+/*******************************  Functions  **********************************/
+/******************************************************************************/
+
+static uint64_t get_le(const uint8_t *p, unsigned int bytes)
+{
+	uint64_t value = 0;
+
+	while (bytes--)
+		value = value << 8 | p[bytes];
+	return value;
+}
+
+/* read a varint, returns false if it exceeds end */
+static bool get_varint(const uint8_t **p, const uint8_t *end, uint64_t *value)
+{
+	unsigned int shift = 0;
+
+	*value = 0;
+	while (*p < end && shift < 64) {
+		uint8_t b = *(*p)++;
+
+		*value |= (uint64_t)(b & 0x7f) << shift;
+		if (!(b & 0x80))
+			return true;
+		shift += 7;
+	}
+	return false;
+}
+
+/* read the header of the record at p, returns false if it is incomplete */
+static bool get_record(const struct pi_cap *cap, const uint8_t *p, uint8_t *type,
+		       const uint8_t **payload, uint64_t *size)
+{
+	const uint8_t *end = cap->map + cap->size;
+
+	if (p >= end)
+		return false;
+	*type = *p++;
+	if (!get_varint(&p, end, size) || *size > (uint64_t)(end - p))
+		return false;
+	*payload = p;
+	return true;
+}
+
+/* load the index records chained from the end record */
+static bool load_index(struct pi_cap *cap, uint64_t pos)
+{
+	const uint8_t *payload;
+	uint64_t size, count = 0, n, p;
+	uint8_t type;
+
+	/* count the keyframes first, then fill the index from the back */
+	for (p = pos; p; p = get_le(payload, 8)) {
+		if (p >= cap->size || !get_record(cap, cap->map + p, &type, &payload, &size) ||
+		    type != PI_CAP_INDEX || size < 12 ||
+		    size != 12 + 16 * get_le(payload + 8, 4) || get_le(payload, 8) >= p)
+			return false;
+		count += get_le(payload + 8, 4);
+	}
+
+	cap->index = malloc((count ? count : 1) * sizeof(*cap->index));
+	if (!cap->index)
+		return false;
+	cap->keyframes = count;
+
+	for (p = pos; p; p = get_le(payload, 8)) {
+		get_record(cap, cap->map + p, &type, &payload, &size);
+		n = get_le(payload + 8, 4);
+		count -= n;
+		while (n--) {
+			cap->index[count + n].timestamp = get_le(payload + 12 + 16 * n, 8);
+			cap->index[count + n].pos = get_le(payload + 20 + 16 * n, 8);
+			if (cap->index[count + n].pos >= p)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+/* index the keyframes by walking the records, for captures without end record */
+static int scan_index(struct pi_cap *cap)
+{
+	const uint8_t *p = cap->records, *payload;
+	uint64_t size, allocated = 0;
+	uint8_t type;
+
+	cap->keyframes = 0;
+	cap->samples = 0;
+	while (get_record(cap, p, &type, &payload, &size)) {
+		if (type == PI_CAP_KEYFRAME && size == 8 + (uint64_t)cap->length) {
+			if (cap->keyframes == allocated) {
+				struct pi_cap_index *index;
+
+				allocated = allocated ? allocated * 2 : 1024;
+				index = realloc(cap->index, allocated * sizeof(*index));
+				if (!index) {
+					fprintf(stderr, "Not enough memory\n");
+					return -ENOMEM;
+				}
+				cap->index = index;
+			}
+			cap->index[cap->keyframes].timestamp = get_le(payload, 8);
+			cap->index[cap->keyframes].pos = p - cap->map;
+			cap->keyframes++;
+		}
+		if (type == PI_CAP_KEYFRAME || type == PI_CAP_DELTA)
+			cap->samples++;
+		p = payload + size;
+	}
+	if (p != cap->map + cap->size)
+		fprintf(stderr, "capture is incomplete, ignoring the last record\n");
+
+	return 0;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Open a capture
+ *
+ * The keyframe index is read from the index records, or rebuilt by scanning
+ * the capture if it was not finished. The decoder is positioned at the
+ * first sample.
+ *
+ * @param[in]   path	file written with --format cap
+ * @param[out]  cap	opened capture
+ *
+ * @return 0 on success, < 0 on error
+ *
+ ************************************************************************************/
+int piCapOpen(const char *path, struct pi_cap *cap)
+{
+	struct pi_rec rec;
+	const uint8_t *end;
+	int rc;
+
+	memset(cap, 0, sizeof(*cap));
+
+	rc = piRecOpen(path, &rec);
+	if (rc < 0)
+		return rc;
+	if (!rec.capture) {
+		fprintf(stderr, "%s is no capture\n", path);
+		piRecClose(&rec);
+		return -EINVAL;
+	}
+	cap->map = rec.map;
+	cap->size = rec.size;
+	cap->vars = rec.vars;
+	cap->count = rec.count;
+	cap->offset = rec.offset;
+	cap->length = rec.length;
+	cap->records = rec.records;
+
+	cap->frame = calloc(cap->length ? cap->length : 1, 1);
+	if (!cap->frame) {
+		fprintf(stderr, "Not enough memory\n");
+		piCapClose(cap);
+		return -ENOMEM;
+	}
+
+	end = cap->map + cap->size - PI_CAP_END_SIZE;
+	if (cap->size >= PI_CAP_END_SIZE && end >= cap->records && end[0] == PI_CAP_END &&
+	    end[1] == PI_CAP_END_SIZE - 2 && !memcmp(end + 18, PI_CAP_END_MAGIC, 8) &&
+	    load_index(cap, get_le(end + 2, 8))) {
+		cap->samples = get_le(end + 10, 8);
+	} else {
+		free(cap->index);
+		cap->index = NULL;
+		rc = scan_index(cap);
+		if (rc < 0) {
+			piCapClose(cap);
+			return rc;
+		}
+	}
+
+	cap->next = cap->records;
+	cap->lo = 0;
+	cap->hi = cap->length;
+	return 0;
+}
+
+void piCapClose(struct pi_cap *cap)
+{
+	struct pi_rec rec = {
+		.map = cap->map,
+		.size = cap->size,
+		.vars = cap->vars,
+	};
+
+	piRecClose(&rec);
+	free(cap->index);
+	free(cap->frame);
+	memset(cap, 0, sizeof(*cap));
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Position the decoder before a point in time
+ *
+ * The next call of piCapNext() returns the sample of the last keyframe at or
+ * before timestamp, or the first sample if there is none. Samples before
+ * timestamp have to be skipped by the caller.
+ *
+ * @param[in]   cap		capture
+ * @param[in]   timestamp	ns since the epoch
+ *
+ * @return 0
+ *
+ ************************************************************************************/
+int piCapSeek(struct pi_cap *cap, uint64_t timestamp)
+{
+	uint64_t lo = 0, hi = cap->keyframes;
+
+	/* first keyframe after timestamp */
+	while (lo < hi) {
+		uint64_t mid = lo + (hi - lo) / 2;
+
+		if (cap->index[mid].timestamp <= timestamp)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	cap->next = lo ? cap->map + cap->index[lo - 1].pos : cap->records;
+	cap->have_frame = false;
+	return 0;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Decode the next sample
+ *
+ * @param[in]   cap	capture
+ *
+ * @return 1 if cap->timestamp and cap->frame hold the next sample, 0 at the
+ *         end of the capture, < 0 if it is corrupt
+ *
+ ************************************************************************************/
+int piCapNext(struct pi_cap *cap)
+{
+	const uint8_t *payload, *p, *end;
+	uint64_t size, delta, skip, n, pos, i;
+	uint8_t type;
+
+	for (;;) {
+		if (!get_record(cap, cap->next, &type, &payload, &size))
+			return 0;
+		cap->next = payload + size;
+
+		switch (type) {
+		case PI_CAP_KEYFRAME:
+			if (size != 8 + (uint64_t)cap->length)
+				return -EINVAL;
+			cap->timestamp = get_le(payload, 8);
+			memcpy(cap->frame + cap->lo, payload + 8 + cap->lo, cap->hi - cap->lo);
+			cap->have_frame = true;
+			return 1;
+		case PI_CAP_DELTA:
+			/* changes before the first keyframe cannot be applied */
+			if (!cap->have_frame)
+				continue;
+			p = payload;
+			end = payload + size;
+			if (!get_varint(&p, end, &delta))
+				return -EINVAL;
+			cap->timestamp += delta;
+			pos = 0;
+			while (p < end) {
+				if (!get_varint(&p, end, &skip) || !get_varint(&p, end, &n) ||
+				    n > (uint64_t)(end - p) || skip + n > cap->length - pos)
+					return -EINVAL;
+				pos += skip;
+				/* the changes are in ascending order */
+				if (pos >= cap->hi)
+					break;
+				for (i = pos > cap->lo ? pos : cap->lo; i < pos + n && i < cap->hi; i++)
+					cap->frame[i] ^= p[i - pos];
+				p += n;
+				pos += n;
+			}
+			return 1;
+		default:
+			/* index and end records */
+			continue;
+		}
+	}
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Restrict decoding to a region of the process image
+ *
+ * Only the captured bytes in the region are kept up to date by
+ * piCapNext(), the other bytes of cap->frame are undefined. Has to be
+ * called before piCapSeek().
+ *
+ * @param[in]   cap	capture
+ * @param[in]   offset	region of the process image
+ * @param[in]   length
+ *
+ ************************************************************************************/
+void piCapSetRange(struct pi_cap *cap, uint32_t offset, uint32_t length)
+{
+	uint32_t end = offset + length;
+
+	if (offset < cap->offset)
+		offset = cap->offset;
+	if (end > cap->offset + cap->length)
+		end = cap->offset + cap->length;
+	if (end < offset)
+		end = offset;
+	cap->lo = offset - cap->offset;
+	cap->hi = end - cap->offset;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Decode a capture to stdout
+ *
+ * @param[in]   path	file written with --format cap
+ * @param[in]   type	output format, CSV for the text format
+ *
+ * @return 0 on success, < 0 on error
+ *
+ ************************************************************************************/
+int piCapDecode(const char *path, int type)
+{
+	struct pi_format *fmt;
+	struct pi_cap cap;
+	int rc;
+
+	rc = piCapOpen(path, &cap);
+	if (rc < 0)
+		return rc;
+
+	fmt = malloc(sizeof(*fmt));
+	if (!fmt) {
+		fprintf(stderr, "Not enough memory\n");
+		piCapClose(&cap);
+		return -ENOMEM;
+	}
+	rc = piFormatInit(fmt, type == PI_FORMAT_TEXT ? PI_FORMAT_CSV : type, STDOUT_FILENO,
+			  cap.vars, cap.count);
+	if (rc < 0)
+		goto out;
+	fmt->wall_offset = 0;
+
+	fflush(stdout);
+	piFormatHeader(fmt);
+	while ((rc = piCapNext(&cap)) > 0) {
+		/* the variables may span less than the captured bytes */
+		rc = piFormatSample(fmt, cap.timestamp, cap.frame + (fmt->offset - cap.offset));
+		if (rc < 0)
+			break;
+	}
+	if (rc < 0 && rc != fmt->error)
+		fprintf(stderr, "%s is corrupt\n", path);
+	if (piFormatFinish(fmt) < 0) {
+		fprintf(stderr, "Failed to write output: %s\n", strerror(-fmt->error));
+		rc = fmt->error;
+	}
+
+out:
+	free(fmt);
+	piCapClose(&cap);
+	return rc;
+}
+
+/* parse a point in time of a query, see piCapQuery() */
+static int parse_time(const char *s, const struct pi_cap *cap, uint64_t *timestamp)
+{
+	double seconds = 0;
+	struct tm tm;
+	time_t t;
+	char *end;
+
+	if (*s == '+') {
+		seconds = strtod(s + 1, &end);
+		if (end == s + 1 || *end || seconds < 0)
+			return -EINVAL;
+		*timestamp = (cap->keyframes ? cap->index[0].timestamp : 0) +
+			     (uint64_t)(seconds * 1e9);
+		return 0;
+	}
+
+	if (strchr(s, 'T')) {
+		memset(&tm, 0, sizeof(tm));
+		end = strptime(s, "%Y-%m-%dT%H:%M:%S", &tm);
+		if (!end)
+			return -EINVAL;
+		if (*end == '.')
+			seconds = strtod(end, &end);
+		if (*end)
+			return -EINVAL;
+		tm.tm_isdst = -1;
+		t = mktime(&tm);
+		if (t == (time_t)-1)
+			return -EINVAL;
+		*timestamp = (uint64_t)t * 1000000000ULL + (uint64_t)(seconds * 1e9);
+		return 0;
+	}
+
+	seconds = strtod(s, &end);
+	if (end == s || *end || seconds < 0)
+		return -EINVAL;
+	*timestamp = (uint64_t)(seconds * 1e9);
+	return 0;
+}
+
+struct query_stats {
+	uint64_t count;
+	int64_t min, max;
+	double sum;
+};
+
+/***********************************************************************************/
+/*!
+ * @brief Print the samples of a time range of a capture
+ *
+ * The decoding starts at the last keyframe before the range, found in the
+ * keyframe index, and is restricted to the bytes of the requested
+ * variables. A point in time is given as seconds since the epoch, as local
+ * time YYYY-MM-DDTHH:MM:SS[.frac] or as +seconds since the start of the
+ * capture.
+ *
+ * @param[in]   query	capture, variables and range
+ *
+ * @return 0 on success, < 0 on error
+ *
+ ************************************************************************************/
+int piCapQuery(const struct pi_cap_query *query)
+{
+	struct query_stats *stats = NULL;
+	struct pi_format *fmt = NULL;
+	struct pi_var *vars = NULL;
+	uint64_t from = 0, to = UINT64_MAX, first = 0, last = 0;
+	struct pi_span span;
+	struct pi_cap cap;
+	unsigned int i, j, count;
+	int rc;
+
+	rc = piCapOpen(query->path, &cap);
+	if (rc < 0)
+		return rc;
+
+	if (query->from && parse_time(query->from, &cap, &from) < 0) {
+		fprintf(stderr, "Invalid time '%s'\n", query->from);
+		rc = -EINVAL;
+		goto out;
+	}
+	if (query->to && parse_time(query->to, &cap, &to) < 0) {
+		fprintf(stderr, "Invalid time '%s'\n", query->to);
+		rc = -EINVAL;
+		goto out;
+	}
+
+	count = query->nvars ? query->nvars : cap.count;
+	vars = calloc(count ? count : 1, sizeof(*vars));
+	stats = calloc(count ? count : 1, sizeof(*stats));
+	if (!vars || !stats) {
+		fprintf(stderr, "Not enough memory\n");
+		rc = -ENOMEM;
+		goto out;
+	}
+	piSpanInit(&span);
+	for (i = 0; i < count; i++) {
+		if (query->nvars) {
+			for (j = 0; j < cap.count; j++)
+				if (!strcmp(cap.vars[j].name, query->vars[i]))
+					break;
+			if (j == cap.count) {
+				fprintf(stderr, "Variable '%s' is not part of the capture\n",
+					query->vars[i]);
+				rc = -ENOENT;
+				goto out;
+			}
+		} else {
+			j = i;
+		}
+		vars[i] = cap.vars[j];
+		piSpanAdd(&span, vars[i].offset, piImageVarBytes(&vars[i]));
+		stats[i].min = INT64_MAX;
+		stats[i].max = INT64_MIN;
+	}
+
+	if (!query->aggregate) {
+		fmt = malloc(sizeof(*fmt));
+		if (!fmt) {
+			fprintf(stderr, "Not enough memory\n");
+			rc = -ENOMEM;
+			goto out;
+		}
+		rc = piFormatInit(fmt, query->type == PI_FORMAT_TEXT ? PI_FORMAT_CSV : query->type,
+				  STDOUT_FILENO, vars, count);
+		if (rc < 0) {
+			free(fmt);
+			fmt = NULL;
+			goto out;
+		}
+		fmt->wall_offset = 0;
+		fflush(stdout);
+		piFormatHeader(fmt);
+	}
+
+	piCapSetRange(&cap, span.offset, span.length);
+	piCapSeek(&cap, from);
+	while ((rc = piCapNext(&cap)) > 0) {
+		if (cap.timestamp < from)
+			continue;
+		if (cap.timestamp > to)
+			break;
+
+		if (fmt) {
+			rc = piFormatSample(fmt, cap.timestamp, cap.frame + (fmt->offset - cap.offset));
+			if (rc < 0)
+				break;
+			continue;
+		}
+
+		if (stats[0].count == 0)
+			first = cap.timestamp;
+		last = cap.timestamp;
+		for (i = 0; i < count; i++) {
+			int64_t value = piImageValue(cap.frame, cap.offset, &vars[i]);
+
+			if (value < stats[i].min)
+				stats[i].min = value;
+			if (value > stats[i].max)
+				stats[i].max = value;
+			stats[i].sum += value;
+			stats[i].count++;
+		}
+	}
+	if (rc < 0 && (!fmt || rc != fmt->error))
+		fprintf(stderr, "%s is corrupt\n", query->path);
+
+	if (fmt) {
+		if (piFormatFinish(fmt) < 0) {
+			fprintf(stderr, "Failed to write output: %s\n", strerror(-fmt->error));
+			rc = fmt->error;
+		}
+		free(fmt);
+	} else if (count && stats[0].count) {
+		printf("%" PRIu64 " samples from %" PRIu64 ".%09" PRIu64 " to %" PRIu64 ".%09" PRIu64 "\n",
+		       stats[0].count, first / 1000000000, first % 1000000000,
+		       last / 1000000000, last % 1000000000);
+		printf("%-32s %12s %12s %14s\n", "variable", "min", "max", "mean");
+		for (i = 0; i < count; i++)
+			printf("%-32s %12" PRId64 " %12" PRId64 " %14.3f\n", vars[i].name,
+			       stats[i].min, stats[i].max, stats[i].sum / stats[i].count);
+	} else if (rc >= 0) {
+		printf("no samples in the range\n");
+	}
+
+out:
+	free(stats);
+	free(vars);
+	piCapClose(&cap);
+	return rc < 0 ? rc : 0;
+}
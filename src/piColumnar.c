@@ -0,0 +1,318 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+/*!
+ * Project: piTest
+ * Demo source code for usage of piControl driver
+ *
+ * \file piColumnar.c
+ *
+ * \brief Conversion of recordings into a columnar layout
+ *
+ * A recording written with --format bin holds one frame of process image
+ * bytes per sample. For analysis it is converted into one contiguous column
+ * per variable plus a column of timestamps, each with a fixed width per
+ * sample. Columns with few distinct values are dictionary encoded, slowly
+ * changing ones, like the timestamps, delta encoded with the smallest width
+ * that holds all differences.
+ */
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "piColumnar.h"
+
+/******************************************************************************/
+/*********************************  Types  ************************************/
+/******************************************************************************/
+
+#define DICT_SLOTS	(2 * PI_COL_DICT_MAX)
+
+/* Distinct values of a column, in the order of their first appearance */
+struct dict {
+	int64_t values[PI_COL_DICT_MAX];
+	unsigned int count;
+	bool full;			/* more than PI_COL_DICT_MAX values */
+	uint16_t slots[DICT_SLOTS];	/* hash table of index + 1 */
+};
+
+/******************************************************************************/
+/*******************************  Functions  **********************************/
+/******************************************************************************/
+
+/* value of a column, column 0 are the timestamps */
+static int64_t column_value(const struct pi_rec *rec, unsigned int col, uint64_t sample)
+{
+	if (col == 0)
+		return piRecTimestamp(rec, sample);
+	return piImageValue(piRecData(rec, sample), rec->offset, &rec->vars[col - 1]);
+}
+
+/* index of a value in the dictionary, added if new, -1 if the dictionary is full */
+static int dict_index(struct dict *dict, int64_t value)
+{
+	/* top 9 bits of a multiplicative hash, DICT_SLOTS is 512 */
+	unsigned int h = ((uint64_t)value * 0x9e3779b97f4a7c15ULL) >> 55;
+
+	for (;; h = (h + 1) % DICT_SLOTS) {
+		unsigned int slot = dict->slots[h];
+
+		if (slot == 0)
+			break;
+		if (dict->values[slot - 1] == value)
+			return slot - 1;
+	}
+	if (dict->count == PI_COL_DICT_MAX) {
+		dict->full = true;
+		return -1;
+	}
+	dict->values[dict->count] = value;
+	dict->slots[h] = ++dict->count;
+
+	return dict->count - 1;
+}
+
+/* smallest width in bytes that holds a signed value */
+static unsigned int signed_width(int64_t min, int64_t max)
+{
+	if (min >= INT8_MIN && max <= INT8_MAX)
+		return 1;
+	if (min >= INT16_MIN && max <= INT16_MAX)
+		return 2;
+	if (min >= INT32_MIN && max <= INT32_MAX)
+		return 4;
+	return 8;
+}
+
+/* choose the encoding of a column with the smallest size */
+static void plan_column(const struct pi_rec *rec, unsigned int col,
+			struct pi_col_entry *entry, struct dict *dict)
+{
+	uint64_t n = rec->samples, i, raw, delta, dict_size;
+	int64_t prev = 0, value, min_delta = 0, max_delta = 0;
+	unsigned int delta_width;
+
+	memset(entry, 0, sizeof(*entry));
+	if (col == 0) {
+		strcpy(entry->name, "ts_ns");
+		entry->length = 64;
+		entry->width = 8;
+	} else {
+		const struct pi_var *var = &rec->vars[col - 1];
+
+		snprintf(entry->name, sizeof(entry->name), "%s", var->name);
+		entry->offset = var->offset;
+		entry->length = var->length;
+		entry->bit = var->bit;
+		entry->is_signed = var->is_signed;
+		entry->width = var->length <= 8 ? 1 : var->length / 8;
+	}
+
+	for (i = 0; i < n; i++) {
+		value = column_value(rec, col, i);
+		if (i == 0) {
+			entry->base = value;
+		} else {
+			/* the difference of two values of up to 32 bits cannot overflow */
+			int64_t d = col == 0 ? (int64_t)((uint64_t)value - (uint64_t)prev) :
+				    value - prev;
+
+			if (d < min_delta)
+				min_delta = d;
+			if (d > max_delta)
+				max_delta = d;
+		}
+		prev = value;
+		/* a byte per sample is already the size of a dictionary index */
+		if (entry->width > 1 && !dict->full)
+			dict_index(dict, value);
+	}
+
+	delta_width = signed_width(min_delta, max_delta);
+	raw = n * entry->width;
+	delta = n * delta_width;
+	dict_size = entry->width > 1 && !dict->full ? dict->count * 8 + n : UINT64_MAX;
+
+	entry->encoding = PI_COL_RAW;
+	entry->size = raw;
+	if (delta < entry->size) {
+		entry->encoding = PI_COL_DELTA;
+		entry->width = delta_width;
+		entry->size = delta;
+	}
+	if (dict_size < entry->size) {
+		entry->encoding = PI_COL_DICT;
+		entry->width = 1;
+		entry->dict_size = dict->count;
+		entry->size = dict_size;
+	}
+	if (entry->encoding != PI_COL_DELTA)
+		entry->base = 0;
+}
+
+static void put_le(FILE *out, uint64_t value, unsigned int bytes)
+{
+	unsigned int i;
+
+	for (i = 0; i < bytes; i++)
+		putc_unlocked((value >> (8 * i)) & 0xff, out);
+}
+
+static void put_padding(FILE *out, uint64_t *pos)
+{
+	while (*pos % PI_COL_ALIGN) {
+		putc_unlocked(0, out);
+		(*pos)++;
+	}
+}
+
+static void write_entry(FILE *out, const struct pi_col_entry *entry)
+{
+	fwrite(entry->name, sizeof(entry->name), 1, out);
+	put_le(out, entry->offset, 2);
+	put_le(out, entry->length, 2);
+	put_le(out, entry->bit, 1);
+	put_le(out, entry->is_signed, 1);
+	put_le(out, entry->encoding, 1);
+	put_le(out, entry->width, 1);
+	put_le(out, entry->dict_size, 4);
+	put_le(out, 0, 4);
+	put_le(out, entry->base, 8);
+	put_le(out, entry->data, 8);
+	put_le(out, entry->size, 8);
+}
+
+static void write_column(FILE *out, const struct pi_rec *rec, unsigned int col,
+			 const struct pi_col_entry *entry, struct dict *dict)
+{
+	int64_t prev = entry->base, value;
+	uint64_t i;
+
+	if (entry->encoding == PI_COL_DICT) {
+		for (i = 0; i < dict->count; i++)
+			put_le(out, dict->values[i], 8);
+	}
+
+	for (i = 0; i < rec->samples; i++) {
+		value = column_value(rec, col, i);
+		switch (entry->encoding) {
+		case PI_COL_DICT:
+			put_le(out, dict_index(dict, value), 1);
+			break;
+		case PI_COL_DELTA:
+			put_le(out, (uint64_t)value - (uint64_t)prev, entry->width);
+			prev = value;
+			break;
+		default:
+			put_le(out, value, entry->width);
+			break;
+		}
+	}
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Convert a recording into a columnar file
+ *
+ * The variables, with name, offset and type, are taken from the header of
+ * the recording, which was filled by the variable lookup when recording.
+ * A summary of the columns is printed.
+ *
+ * @param[in]   recording	file written with --format bin
+ * @param[in]   output		columnar file to create
+ *
+ * @return 0 on success, < 0 on error
+ *
+ ************************************************************************************/
+int piColumnarConvert(const char *recording, const char *output)
+{
+	const uint64_t header_size = 24, entry_size = 72;
+	struct pi_col_entry *entries = NULL;
+	struct dict *dicts = NULL;
+	struct pi_rec rec;
+	unsigned int columns, col;
+	uint64_t pos, total = 0;
+	FILE *out;
+	int rc;
+
+	rc = piRecOpen(recording, &rec);
+	if (rc < 0)
+		return rc;
+	if (rec.capture) {
+		fprintf(stderr, "%s is a capture, convert it with --format bin --decode first\n",
+			recording);
+		piRecClose(&rec);
+		return -EINVAL;
+	}
+
+	columns = rec.count + 1;
+	entries = calloc(columns, sizeof(*entries));
+	dicts = calloc(columns, sizeof(*dicts));
+	if (!entries || !dicts) {
+		fprintf(stderr, "Not enough memory\n");
+		rc = -ENOMEM;
+		goto out;
+	}
+
+	pos = header_size + columns * entry_size;
+	for (col = 0; col < columns; col++) {
+		plan_column(&rec, col, &entries[col], &dicts[col]);
+		pos = (pos + PI_COL_ALIGN - 1) / PI_COL_ALIGN * PI_COL_ALIGN;
+		entries[col].data = pos;
+		pos += entries[col].size;
+	}
+
+	out = fopen(output, "we");
+	if (!out) {
+		rc = -errno;
+		fprintf(stderr, "Cannot create %s: %s\n", output, strerror(errno));
+		goto out;
+	}
+	setvbuf(out, NULL, _IOFBF, 1 << 20);
+
+	fwrite(PI_COL_MAGIC, 8, 1, out);
+	put_le(out, PI_COL_VERSION, 2);
+	put_le(out, columns, 2);
+	put_le(out, 0, 4);
+	put_le(out, rec.samples, 8);
+	for (col = 0; col < columns; col++)
+		write_entry(out, &entries[col]);
+
+	pos = header_size + columns * entry_size;
+	for (col = 0; col < columns; col++) {
+		put_padding(out, &pos);
+		write_column(out, &rec, col, &entries[col], &dicts[col]);
+		pos += entries[col].size;
+	}
+
+	if (ferror(out) | fclose(out)) {
+		rc = -errno;
+		fprintf(stderr, "Failed to write %s: %s\n", output, strerror(errno));
+		goto out;
+	}
+
+	printf("%" PRIu64 " samples of %u variables\n", rec.samples, rec.count);
+	for (col = 0; col < columns; col++) {
+		static const char *const encodings[] = { "raw", "dict", "delta" };
+
+		printf("%-32s %-5s %u byte%s %10" PRIu64 " bytes\n", entries[col].name,
+		       encodings[entries[col].encoding], entries[col].width,
+		       entries[col].width > 1 ? "s" : " ", entries[col].size);
+		total += entries[col].size;
+	}
+	printf("%" PRIu64 " bytes of column data, %zu bytes recorded\n", total, rec.size);
+
+out:
+	free(dicts);
+	free(entries);
+	piRecClose(&rec);
+	return rc;
+}
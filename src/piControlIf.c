@@ -26,10 +26,34 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <time.h>
 
 #include "piControlIf.h"
+#include "piTrace.h"
 
 #include "piControl.h"
+#ifdef PITEST_SIMULATION
+#include "piControlSim.h"
+#endif
+#ifdef PITEST_IO_URING
+#include "piUring.h"
+#endif
+
+/******************************************************************************/
+/*********************************  Types  ************************************/
+/******************************************************************************/
+
+/* accesses to the piControl device or to its simulation */
+struct pi_backend {
+	const char *name;
+	int (*open)(void);
+	void (*close)(int fd);
+	ssize_t (*read)(int fd, void *buf, size_t count, off_t offset);
+	ssize_t (*write)(int fd, const void *buf, size_t count, off_t offset);
+	int (*ioctl)(int fd, unsigned long request, void *arg);
+};
 
 /******************************************************************************/
 /******************************  Global Vars  *********************************/
@@ -37,10 +61,206 @@
 
 int PiControlHandle_g = -1;
 
+/* device list of piControlGetDeviceList(), read once */
+static SDeviceInfo device_list[REV_PI_DEV_CNT_MAX];
+static int device_count = -1;
+
+static int device_open(void)
+{
+	return open(PICONTROL_DEVICE, O_RDWR);
+}
+
+static void device_close(int fd)
+{
+	close(fd);
+}
+
+static int device_ioctl(int fd, unsigned long request, void *arg)
+{
+	return ioctl(fd, request, arg);
+}
+
+static const struct pi_backend device_backend = {
+	.name = PICONTROL_DEVICE,
+	.open = device_open,
+	.close = device_close,
+	.read = pread,
+	.write = pwrite,
+	.ioctl = device_ioctl,
+};
+
+#ifdef PITEST_SIMULATION
+static int sim_open(void)
+{
+	return piSimOpen(getenv(PICONTROL_SIM_ENV));
+}
+
+static const struct pi_backend sim_backend = {
+	.name = "simulated piControl",
+	.open = sim_open,
+	.close = piSimClose,
+	.read = piSimRead,
+	.write = piSimWrite,
+	.ioctl = piSimIoctl,
+};
+#endif
+
+static const struct pi_backend *backend = &device_backend;
+
+/*
+ * Tracepoints around every access to the device:
+ *   read_entry(offset, length), read_return(offset, length, ret, ns)
+ *   write_entry(offset, length), write_return(offset, length, ret, ns)
+ *   ioctl_entry(request, arg), ioctl_return(request, arg, ret, ns)
+ * ret is negative errno on error, ns the duration of the call.
+ */
+PI_TRACE_SEMAPHORE(read_entry);
+PI_TRACE_SEMAPHORE(read_return);
+PI_TRACE_SEMAPHORE(write_entry);
+PI_TRACE_SEMAPHORE(write_return);
+PI_TRACE_SEMAPHORE(ioctl_entry);
+PI_TRACE_SEMAPHORE(ioctl_return);
+
+/* per operation statistics, see piControlStatsEnable() */
+struct stats_counters {
+	atomic_uint_fast64_t calls;
+	atomic_uint_fast64_t bytes;
+	atomic_uint_fast64_t errors;
+	atomic_uint_fast64_t total_ns;
+	atomic_uint_fast64_t max_ns;
+	atomic_uint_fast64_t hist[PI_STATS_BUCKETS];
+};
+
+static struct {
+	bool enabled;
+	uint64_t start;
+	struct stats_counters ops[PI_STATS_OPS];
+} stats;
+
+static const char *stats_names[PI_STATS_OPS] = {
+	[PI_STATS_READ] = "read",
+	[PI_STATS_WRITE] = "write",
+	[PI_STATS_GET_BIT] = "get bit",
+	[PI_STATS_SET_BIT] = "set bit",
+	[PI_STATS_FIND_VARIABLE] = "find variable",
+	[PI_STATS_DEVICE_INFO] = "device info",
+	[PI_STATS_OTHER_IOCTL] = "other ioctl",
+};
+
 /******************************************************************************/
 /*******************************  Functions  **********************************/
 /******************************************************************************/
 
+static inline uint64_t timestamp_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static enum pi_stats_op stats_ioctl_op(unsigned long request)
+{
+	switch (request) {
+	case KB_GET_VALUE:
+		return PI_STATS_GET_BIT;
+	case KB_SET_VALUE:
+		return PI_STATS_SET_BIT;
+	case KB_FIND_VARIABLE:
+		return PI_STATS_FIND_VARIABLE;
+	case KB_GET_DEVICE_INFO:
+	case KB_GET_DEVICE_INFO_LIST:
+		return PI_STATS_DEVICE_INFO;
+	default:
+		return PI_STATS_OTHER_IOCTL;
+	}
+}
+
+static void stats_add(enum pi_stats_op op, ssize_t ret, uint64_t ns)
+{
+	struct stats_counters *c = &stats.ops[op];
+	unsigned int bucket = 63 - __builtin_clzll(ns | 1);
+	uint64_t max;
+
+	atomic_fetch_add_explicit(&c->calls, 1, memory_order_relaxed);
+	if (ret < 0)
+		atomic_fetch_add_explicit(&c->errors, 1, memory_order_relaxed);
+	else if (op == PI_STATS_READ || op == PI_STATS_WRITE)
+		atomic_fetch_add_explicit(&c->bytes, ret, memory_order_relaxed);
+	atomic_fetch_add_explicit(&c->total_ns, ns, memory_order_relaxed);
+	atomic_fetch_add_explicit(&c->hist[bucket < PI_STATS_BUCKETS ? bucket : PI_STATS_BUCKETS - 1],
+				  1, memory_order_relaxed);
+
+	max = atomic_load_explicit(&c->max_ns, memory_order_relaxed);
+	while (ns > max && !atomic_compare_exchange_weak_explicit(&c->max_ns, &max, ns,
+								  memory_order_relaxed,
+								  memory_order_relaxed))
+		;
+}
+
+static ssize_t pi_read(uint32_t offset, uint32_t length, uint8_t *data)
+{
+	bool timed = stats.enabled || PI_TRACE_ENABLED(read_return);
+	uint64_t start = 0, ns;
+	ssize_t ret;
+
+	PI_TRACE2(read_entry, offset, length);
+	if (timed)
+		start = timestamp_ns();
+
+	ret = backend->read(PiControlHandle_g, data, length, offset);
+
+	if (timed) {
+		ns = timestamp_ns() - start;
+		PI_TRACE4(read_return, offset, length, ret < 0 ? -errno : ret, ns);
+		if (stats.enabled)
+			stats_add(PI_STATS_READ, ret, ns);
+	}
+	return ret;
+}
+
+static ssize_t pi_write(uint32_t offset, uint32_t length, const uint8_t *data)
+{
+	bool timed = stats.enabled || PI_TRACE_ENABLED(write_return);
+	uint64_t start = 0, ns;
+	ssize_t ret;
+
+	PI_TRACE2(write_entry, offset, length);
+	if (timed)
+		start = timestamp_ns();
+
+	ret = backend->write(PiControlHandle_g, data, length, offset);
+
+	if (timed) {
+		ns = timestamp_ns() - start;
+		PI_TRACE4(write_return, offset, length, ret < 0 ? -errno : ret, ns);
+		if (stats.enabled)
+			stats_add(PI_STATS_WRITE, ret, ns);
+	}
+	return ret;
+}
+
+static int pi_ioctl(unsigned long request, void *arg)
+{
+	bool timed = stats.enabled || PI_TRACE_ENABLED(ioctl_return);
+	uint64_t start = 0, ns;
+	int ret;
+
+	PI_TRACE2(ioctl_entry, request, arg);
+	if (timed)
+		start = timestamp_ns();
+
+	ret = backend->ioctl(PiControlHandle_g, request, arg);
+
+	if (timed) {
+		ns = timestamp_ns() - start;
+		PI_TRACE4(ioctl_return, request, arg, ret < 0 ? -errno : ret, ns);
+		if (stats.enabled)
+			stats_add(stats_ioctl_op(request), ret, ns);
+	}
+	return ret;
+}
+
 /***********************************************************************************/
 /*!
  * @brief Open Pi Control Interface
@@ -52,9 +272,13 @@ int piControlOpen(void)
 {
 	/* open handle if needed */
 	if (PiControlHandle_g < 0) {
-		PiControlHandle_g = open(PICONTROL_DEVICE, O_RDWR);
+#ifdef PITEST_SIMULATION
+		if (getenv(PICONTROL_SIM_ENV))
+			backend = &sim_backend;
+#endif
+		PiControlHandle_g = backend->open();
 		if (PiControlHandle_g < 0) {
-			fprintf(stderr, "Failed to open " PICONTROL_DEVICE ": %s\n",
+			fprintf(stderr, "Failed to open %s: %s\n", backend->name,
 				strerror(errno));
 			return -1;
 		}
@@ -74,9 +298,10 @@ void piControlClose(void)
 {
 	/* open handle if needed */
 	if (PiControlHandle_g > 0) {
-		close(PiControlHandle_g);
+		backend->close(PiControlHandle_g);
 		PiControlHandle_g = -1;
 	}
+	device_count = -1;
 }
 
 /***********************************************************************************/
@@ -94,7 +319,8 @@ int piControlReset(void)
 	if (ret < 0)
 		return ret;
 
-	if (ioctl(PiControlHandle_g, KB_RESET, NULL) < 0) {
+	device_count = -1;
+	if (pi_ioctl(KB_RESET, NULL) < 0) {
 		fprintf(stderr, "Failed to reset piControl: %s\n", strerror(errno));
 		return -1;
 	}
@@ -118,7 +344,7 @@ int piControlWaitForEvent(void)
 	if (ret < 0)
 		return ret;
 
-	if (ioctl(PiControlHandle_g, KB_WAIT_FOR_EVENT, &event) < 0) {
+	if (pi_ioctl(KB_WAIT_FOR_EVENT, &event) < 0) {
 		fprintf(stderr, "Failed to wait for event: %s\n", strerror(errno));
 		return -1;
 	}
@@ -148,16 +374,8 @@ int piControlRead(uint32_t Offset, uint32_t Length, uint8_t * pData)
 	if (ret < 0)
 		return ret;
 
-	/* seek */
-	if (lseek(PiControlHandle_g, Offset, SEEK_SET) < 0) {
-		fprintf(stderr,
-			"Failed to seek to data at offset %" PRIu32 ": %s\n",
-			Offset, strerror(errno));
-		return -1;
-	}
-
-	/* read */
-	BytesRead = read(PiControlHandle_g, pData, Length);
+	/* read, pread() leaves the file position alone so threads can share the handle */
+	BytesRead = pi_read(Offset, Length, pData);
 	if (BytesRead < 0) {
 		fprintf(stderr,
 			"Failed to read data at offset %" PRIu32
@@ -191,16 +409,8 @@ int piControlWrite(uint32_t Offset, uint32_t Length, uint8_t * pData)
 	if (ret < 0)
 		return ret;
 
-	/* seek */
-	if (lseek(PiControlHandle_g, Offset, SEEK_SET) < 0) {
-		fprintf(stderr,
-			"Failed to seek to data at offset %" PRIu32 ": %s\n",
-			Offset, strerror(errno));
-		return -1;
-	}
-
-	/* Write */
-	BytesWritten = write(PiControlHandle_g, pData, Length);
+	/* Write, see piControlRead() */
+	BytesWritten = pi_write(Offset, Length, pData);
 	if (BytesWritten < 0) {
 		fprintf(stderr,
 			"Failed to write data at offset %" PRIu32
@@ -212,6 +422,136 @@ int piControlWrite(uint32_t Offset, uint32_t Length, uint8_t * pData)
 	return BytesWritten;
 }
 
+#ifdef PITEST_IO_URING
+/* probes and statistics of the accesses of transfer_uring(), like pi_read() and pi_write() */
+static void uring_entry(const struct pi_io *ios, unsigned int n)
+{
+	unsigned int i;
+
+	for (i = 0; i < n; i++) {
+		if (ios[i].write)
+			PI_TRACE2(write_entry, ios[i].offset, ios[i].length);
+		else
+			PI_TRACE2(read_entry, ios[i].offset, ios[i].length);
+	}
+}
+
+static void uring_return(const struct pi_io *io, uint64_t ns)
+{
+	if (io->write)
+		PI_TRACE4(write_return, io->offset, io->length, io->result, ns);
+	else
+		PI_TRACE4(read_return, io->offset, io->length, io->result, ns);
+	if (stats.enabled)
+		stats_add(io->write ? PI_STATS_WRITE : PI_STATS_READ, io->result, ns);
+}
+
+/*
+ * The accesses point into the buffers of the caller, so all submitted ones
+ * are reaped before returning, also on errors. If the ring fails it is torn
+ * down and later batches are executed without it.
+ */
+static int transfer_uring(struct pi_io *ios, unsigned int n)
+{
+	bool timed = stats.enabled || PI_TRACE_ENABLED(read_return) ||
+		     PI_TRACE_ENABLED(write_return);
+	struct pi_io *done[64];
+	unsigned int submitted = 0, completed = 0, errors = 0;
+	uint64_t start = 0;
+	int i, rc = 0, err = 0;
+
+	if (timed)
+		start = timestamp_ns();
+
+	while (completed < submitted || (submitted < n && !err)) {
+		if (submitted < n && !err) {
+			rc = piUringSubmit(ios + submitted, n - submitted);
+			if (rc == -EINTR)
+				continue;
+			if (rc < 0) {
+				/* reap the accesses in flight before returning */
+				err = rc;
+				continue;
+			}
+			uring_entry(ios + submitted, rc);
+			submitted += rc;
+		}
+		if (completed == submitted)
+			continue;
+
+		/* wait only if nothing more can be submitted */
+		rc = piUringReap(done, sizeof(done) / sizeof(done[0]),
+				 submitted == n || err || rc == 0);
+		if (rc < 0) {
+			piUringExit();
+			return rc;
+		}
+		for (i = 0; i < rc; i++) {
+			if (done[i]->result < 0)
+				errors++;
+			if (timed)
+				uring_return(done[i], timestamp_ns() - start);
+		}
+		completed += rc;
+	}
+
+	if (err) {
+		/* entries the kernel did not take are still queued */
+		piUringExit();
+		return err;
+	}
+	return errors ? -EIO : 0;
+}
+#endif
+
+/***********************************************************************************/
+/*!
+ * @brief Transfer a batch of process data
+ *
+ * Executes a batch of reads and writes. If an io_uring was set up with
+ * piUringInit() the whole batch is submitted at once, otherwise the
+ * accesses are executed one after another. In both cases the order of the
+ * accesses among each other is not defined.
+ *
+ * piControlRead() and piControlWrite() do not use the ring: a single access
+ * waited for right away costs one system call either way, and they are
+ * called from several threads while the ring is not thread safe.
+ *
+ * @param[in/out]   ios	accesses, the result of each is set
+ * @param[in]       n	number of accesses
+ *
+ * @return 0 if all accesses succeeded, -EIO if some failed, other errors if
+ *         the batch could not be executed
+ *
+ ************************************************************************************/
+int piControlTransfer(struct pi_io *ios, unsigned int n)
+{
+	unsigned int i, errors = 0;
+	ssize_t rc;
+	int ret;
+
+	ret = piControlOpen();
+	if (ret < 0)
+		return ret;
+
+#ifdef PITEST_IO_URING
+	if (piUringActive())
+		return transfer_uring(ios, n);
+#endif
+
+	for (i = 0; i < n; i++) {
+		if (ios[i].write)
+			rc = pi_write(ios[i].offset, ios[i].length, ios[i].data);
+		else
+			rc = pi_read(ios[i].offset, ios[i].length, ios[i].data);
+		ios[i].result = rc < 0 ? -errno : rc;
+		if (rc < 0)
+			errors++;
+	}
+
+	return errors ? -EIO : 0;
+}
+
 /***********************************************************************************/
 /*!
  * @brief Get Device Info
@@ -231,7 +571,7 @@ int piControlGetDeviceInfo(SDeviceInfo * pDev)
 	if (ret < 0)
 		return ret;
 
-	if (ioctl(PiControlHandle_g, KB_GET_DEVICE_INFO, pDev) < 0) {
+	if (pi_ioctl(KB_GET_DEVICE_INFO, pDev) < 0) {
 		fprintf(stderr, "Failed to get device info: %s\n", strerror(errno));
 		return -1;
 	}
@@ -259,7 +599,7 @@ int piControlGetDeviceInfoList(SDeviceInfo * pDev)
 	if (ret < 0)
 		return ret;
 
-	cnt = ioctl(PiControlHandle_g, KB_GET_DEVICE_INFO_LIST, pDev);
+	cnt = pi_ioctl(KB_GET_DEVICE_INFO_LIST, pDev);
 	if (cnt < 0) {
 		fprintf(stderr, "Failed to get device info list: %s\n", strerror(errno));
 		return -1;
@@ -268,6 +608,27 @@ int piControlGetDeviceInfoList(SDeviceInfo * pDev)
 	return cnt;
 }
 
+/***********************************************************************************/
+/*!
+ * @brief Get the cached device list
+ *
+ * The device list is read with the first call and kept until the interface
+ * is reset or closed, so repeated lookups of modules cost no ioctl.
+ *
+ * @param[out]  list	set to the array of devices
+ *
+ * @return Number of devices, < 0 on error
+ *
+ ************************************************************************************/
+int piControlGetDeviceList(const SDeviceInfo **list)
+{
+	if (device_count < 0)
+		device_count = piControlGetDeviceInfoList(device_list);
+	*list = device_list;
+
+	return device_count;
+}
+
 /***********************************************************************************/
 /*!
  * @brief Get Bit Value
@@ -290,7 +651,7 @@ int piControlGetBitValue(SPIValue * pSpiValue)
 	pSpiValue->i16uAddress += pSpiValue->i8uBit / 8;
 	pSpiValue->i8uBit %= 8;
 
-	if (ioctl(PiControlHandle_g, KB_GET_VALUE, pSpiValue) < 0) {
+	if (pi_ioctl(KB_GET_VALUE, pSpiValue) < 0) {
 		fprintf(stderr, "Failed to get bit value: %s\n", strerror(errno));
 		return -1;
 	}
@@ -320,7 +681,7 @@ int piControlSetBitValue(SPIValue * pSpiValue)
 	pSpiValue->i16uAddress += pSpiValue->i8uBit / 8;
 	pSpiValue->i8uBit %= 8;
 
-	if (ioctl(PiControlHandle_g, KB_SET_VALUE, pSpiValue) < 0) {
+	if (pi_ioctl(KB_SET_VALUE, pSpiValue) < 0) {
 		fprintf(stderr, "Failed to set bit value: %s\n", strerror(errno));
 		return -1;
 	}
@@ -347,7 +708,7 @@ int piControlGetVariableInfo(SPIVariable * pSpiVariable)
 	if (ret < 0)
 		return ret;
 
-	if (ioctl(PiControlHandle_g, KB_FIND_VARIABLE, pSpiVariable) < 0) {
+	if (pi_ioctl(KB_FIND_VARIABLE, pSpiVariable) < 0) {
 		fprintf(stderr, "Failed to get variable info: %s\n", strerror(errno));
 		return -1;
 	}
@@ -386,7 +747,7 @@ int piControlResetCounter(int address, int bitfield)
 	tel.i8uAddress = address;
 	tel.i16uBitfield = bitfield;
 
-	ret = ioctl(PiControlHandle_g, KB_DIO_RESET_COUNTER, &tel);
+	ret = pi_ioctl(KB_DIO_RESET_COUNTER, &tel);
 	if (ret < 0) {
 		fprintf(stderr, "Failed to reset counter: %s\n", strerror(errno));
 		return -1;
@@ -394,11 +755,21 @@ int piControlResetCounter(int address, int bitfield)
 	return ret;
 }
 
-int piControlGetROCounters(int address)
+/***********************************************************************************/
+/*!
+ * @brief Read the relay counters of a RO module
+ *
+ * @param[in]   address		address of the module
+ * @param[out]  counters	switching cycles of the relays
+ *
+ * @return 0 on success, < 0 on error
+ *
+ ************************************************************************************/
+int piControlReadROCounters(int address, struct pi_ro_counters *counters)
 {
 	struct revpi_ro_ioctl_counters ioc;
+	struct timespec ts;
 	int ret;
-	int i;
 
 	ret = piControlOpen();
 	if (ret < 0)
@@ -406,15 +777,34 @@ int piControlGetROCounters(int address)
 
 	ioc.addr = address;
 
-	ret = ioctl(PiControlHandle_g, KB_RO_GET_COUNTER, &ioc);
+	ret = pi_ioctl(KB_RO_GET_COUNTER, &ioc);
 	if (ret < 0) {
+		ret = -errno;
 		fprintf(stderr, "Failed to get RO counters: %s\n", strerror(errno));
-		return -1;
+		return ret;
 	}
 
+	clock_gettime(CLOCK_REALTIME, &ts);
+	counters->address = address;
+	counters->timestamp = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+	memcpy(counters->counter, ioc.counter, sizeof(counters->counter));
+
+	return 0;
+}
+
+int piControlGetROCounters(int address)
+{
+	struct pi_ro_counters counters;
+	int ret;
+	int i;
+
+	ret = piControlReadROCounters(address, &counters);
+	if (ret < 0)
+		return ret;
+
 	printf("RO relay counters:\n");
 	for (i = 0; i < REVPI_RO_NUM_RELAYS; i++)
-		printf("     Relay %i: %u\n", i + 1, ioc.counter[i]);
+		printf("     Relay %i: %u\n", i + 1, counters.counter[i]);
 
 	return ret;
 }
@@ -473,7 +863,7 @@ int piControlUpdateFirmware(uint32_t addr_p, bool force_update, int hw_revision)
 	printf("Updating Firmware%s!\n", force_update ? " (forced)" : "");
 	printf("This can take a while. Do not switch off the system!\n");
 
-	ret = ioctl(PiControlHandle_g, PICONTROL_UPLOAD_FIRMWARE, &fwu);
+	ret = pi_ioctl(PICONTROL_UPLOAD_FIRMWARE, &fwu);
 	if (ret < 0) {
 		int err = errno;
 
@@ -486,7 +876,7 @@ int piControlUpdateFirmware(uint32_t addr_p, bool force_update, int hw_revision)
 
 			memset(&dev, 0, sizeof(dev));
 			dev.i8uAddress = addr_p;
-			if (ioctl(PiControlHandle_g, KB_GET_DEVICE_INFO, &dev) >= 0 &&
+			if (pi_ioctl(KB_GET_DEVICE_INFO, &dev) >= 0 &&
 			    (dev.i16uModuleType & PICONTROL_NOT_CONNECTED)) {
 				fprintf(stderr, "The module might be stuck in firmware update mode, "
 					"retry with: piTest --module %" PRIu32 " --rescue %u -f\n",
@@ -536,7 +926,7 @@ int piControlStopIO(int stop)
 	if (ret < 0)
 		return ret;
 
-	ret = ioctl(PiControlHandle_g, KB_STOP_IO, &stop);
+	ret = pi_ioctl(KB_STOP_IO, &stop);
 	if (ret < 0) {
 		fprintf(stderr, "Failed to stop IO: %s\n", strerror(errno));
 		return -1;
@@ -556,7 +946,7 @@ void piShowLastMessage(void)
 {
 	char cMsg[REV_PI_ERROR_MSG_LEN];
     
-	if (ioctl(PiControlHandle_g, KB_GET_LAST_MESSAGE, cMsg) == 0 && cMsg[0])
+	if (pi_ioctl(KB_GET_LAST_MESSAGE, cMsg) == 0 && cMsg[0])
 		puts(cMsg);
 }
 
@@ -575,7 +965,7 @@ int piControlCalibrate(int addr, int channl, int mode, int xval, int yval)
 	if (ret < 0)
 		return ret;
 
-	ret = ioctl(PiControlHandle_g, KB_AIO_CALIBRATE, &cali);
+	ret = pi_ioctl(KB_AIO_CALIBRATE, &cali);
 	if (ret < 0) {
 		fprintf(stderr, "Failed to calibrate: %s\n", strerror(errno));
 		return -1;
@@ -583,3 +973,108 @@ int piControlCalibrate(int addr, int channl, int mode, int xval, int yval)
 
 	return ret;
 }
+
+/***********************************************************************************/
+/*!
+ * @brief Enable the statistics of driver calls
+ *
+ * Counts calls, transferred bytes, errors and the latency of every read,
+ * write and ioctl, grouped by operation. Only while enabled the calls are
+ * timed. The counters can be updated by several threads at once.
+ *
+ * @param[in]   enable	true to start counting, false to stop
+ *
+ ************************************************************************************/
+void piControlStatsEnable(bool enable)
+{
+	if (enable && !stats.start)
+		stats.start = timestamp_ns();
+	stats.enabled = enable;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Get the statistics of one operation
+ *
+ * @param[in]   op	operation
+ * @param[out]  out	copy of the counters
+ *
+ ************************************************************************************/
+void piControlStatsGet(enum pi_stats_op op, struct pi_stats *out)
+{
+	struct stats_counters *c = &stats.ops[op];
+	int i;
+
+	out->calls = atomic_load_explicit(&c->calls, memory_order_relaxed);
+	out->bytes = atomic_load_explicit(&c->bytes, memory_order_relaxed);
+	out->errors = atomic_load_explicit(&c->errors, memory_order_relaxed);
+	out->total_ns = atomic_load_explicit(&c->total_ns, memory_order_relaxed);
+	out->max_ns = atomic_load_explicit(&c->max_ns, memory_order_relaxed);
+	for (i = 0; i < PI_STATS_BUCKETS; i++)
+		out->hist[i] = atomic_load_explicit(&c->hist[i], memory_order_relaxed);
+}
+
+const char *piControlStatsName(enum pi_stats_op op)
+{
+	return stats_names[op];
+}
+
+static void format_ns(char *buf, size_t size, uint64_t ns)
+{
+	if (ns < 1000)
+		snprintf(buf, size, "%uns", (unsigned int)ns);
+	else if (ns < 1000000)
+		snprintf(buf, size, "%.3gus", ns / 1e3);
+	else if (ns < 1000000000)
+		snprintf(buf, size, "%.3gms", ns / 1e6);
+	else
+		snprintf(buf, size, "%.3gs", ns / 1e9);
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Print the statistics of driver calls
+ *
+ * Prints one line per operation which was used and its latency histogram
+ * with power of two buckets, each labelled with its upper bound. The share
+ * of the time since the statistics were enabled which was spent in driver
+ * calls tells whether the time goes to the driver or elsewhere.
+ *
+ * @param[in]   fp	stream to print to
+ *
+ ************************************************************************************/
+void piControlStatsPrint(FILE *fp)
+{
+	struct pi_stats st;
+	uint64_t elapsed, total = 0;
+	char bound[16];
+	int op, i;
+
+	elapsed = stats.start ? timestamp_ns() - stats.start : 0;
+	for (op = 0; op < PI_STATS_OPS; op++) {
+		piControlStatsGet(op, &st);
+		total += st.total_ns;
+	}
+
+	fprintf(fp, "piControl statistics after %.3f s, %.3f s (%.1f%%) in driver calls:\n",
+		elapsed / 1e9, total / 1e9, elapsed ? total * 100.0 / elapsed : 0.0);
+	fprintf(fp, "%-14s %12s %14s %8s %10s %10s\n", "operation", "calls", "bytes",
+		"errors", "avg us", "max us");
+
+	for (op = 0; op < PI_STATS_OPS; op++) {
+		piControlStatsGet(op, &st);
+		if (!st.calls)
+			continue;
+		fprintf(fp, "%-14s %12" PRIu64 " %14" PRIu64 " %8" PRIu64 " %10.3f %10.3f\n",
+			stats_names[op], st.calls, st.bytes, st.errors,
+			st.total_ns / 1e3 / st.calls, st.max_ns / 1e3);
+		fprintf(fp, "  latency:");
+		for (i = 0; i < PI_STATS_BUCKETS; i++) {
+			if (!st.hist[i])
+				continue;
+			format_ns(bound, sizeof(bound), 2ULL << i);
+			fprintf(fp, " <%s:%" PRIu64, bound, st.hist[i]);
+		}
+		fprintf(fp, "\n");
+	}
+}
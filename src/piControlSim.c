@@ -0,0 +1,466 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+/*!
+ * Project: piTest
+ * Demo source code for usage of piControl driver
+ *
+ * \file piControlSim.c
+ *
+ * \brief Simulated piControl device
+ *
+ * Emulates the piControl character device without hardware: the process
+ * image lives in memory or in a file shared by all processes using it, and
+ * the device list and the variables are read from a config file. Reads and
+ * writes are serialised by a lock like in the driver, so the cost of the
+ * interface can be measured apart from the cost of the driver.
+ *
+ * Config file syntax, one entry per line, '#' starts a comment:
+ *
+ *   image <path>
+ *	file holding the process image, anonymous memory if not given
+ *   device <address> <type> <in offset> <in length> <out offset> <out length> [<conf offset> <conf length>]
+ *	module in the device list
+ *   var <name> <offset> <bit> <length in bits>
+ *	variable which can be found by name
+ */
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "piControl.h"
+#include "piControlSim.h"
+
+/* DIO and DI modules have 16 32 bit counters after their first 6 input bytes */
+#define SIM_COUNTER_OFFSET	6
+#define SIM_COUNTERS		16
+
+/******************************************************************************/
+/******************************  Global Vars  *********************************/
+/******************************************************************************/
+
+static struct {
+	int fd;
+	uint8_t *image;
+	pthread_mutex_t lock;
+	SDeviceInfo devs[REV_PI_DEV_CNT_MAX];
+	int ndevs;
+	SPIVariable *vars;
+	unsigned int nvars;
+	unsigned int vars_size;
+	int stop_io;
+} sim = {
+	.fd = -1,
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+/******************************************************************************/
+/*******************************  Functions  **********************************/
+/******************************************************************************/
+
+static int sim_add_device(const char *args)
+{
+	unsigned int addr, type, in_off, in_len, out_off, out_len, conf_off = 0, conf_len = 0;
+	SDeviceInfo *dev;
+	int n;
+
+	n = sscanf(args, "%u %u %u %u %u %u %u %u", &addr, &type, &in_off, &in_len,
+		   &out_off, &out_len, &conf_off, &conf_len);
+	if (n != 6 && n != 8)
+		return -EINVAL;
+	if (addr > 255 || type > UINT16_MAX || in_off + in_len > KB_PI_LEN ||
+	    out_off + out_len > KB_PI_LEN || conf_off + conf_len > KB_PI_LEN)
+		return -ERANGE;
+	if (sim.ndevs == REV_PI_DEV_CNT_MAX)
+		return -ENOSPC;
+
+	dev = &sim.devs[sim.ndevs++];
+	memset(dev, 0, sizeof(*dev));
+	dev->i8uAddress = addr;
+	dev->i16uModuleType = type;
+	dev->i16uInputOffset = in_off;
+	dev->i16uInputLength = in_len;
+	dev->i16uOutputOffset = out_off;
+	dev->i16uOutputLength = out_len;
+	dev->i16uConfigOffset = conf_off;
+	dev->i16uConfigLength = conf_len;
+	dev->i16uBaseOffset = in_off;
+	dev->i8uActive = !(type & PICONTROL_NOT_CONNECTED);
+
+	return 0;
+}
+
+static int sim_add_var(const char *args)
+{
+	char name[sizeof(sim.vars->strVarName)];
+	unsigned int offset, bit, length;
+	SPIVariable *var;
+
+	if (sscanf(args, "%31s %u %u %u", name, &offset, &bit, &length) != 4)
+		return -EINVAL;
+	if (bit > 7 || (length != 1 && length % 8) || offset + (length + 7) / 8 > KB_PI_LEN)
+		return -ERANGE;
+
+	if (sim.nvars == sim.vars_size) {
+		unsigned int size = sim.vars_size ? sim.vars_size * 2 : 64;
+		SPIVariable *vars = realloc(sim.vars, size * sizeof(*vars));
+
+		if (!vars)
+			return -ENOMEM;
+		sim.vars = vars;
+		sim.vars_size = size;
+	}
+
+	var = &sim.vars[sim.nvars++];
+	memset(var, 0, sizeof(*var));
+	strcpy(var->strVarName, name);
+	var->i16uAddress = offset;
+	var->i8uBit = bit;
+	var->i16uLength = length;
+
+	return 0;
+}
+
+static void free_vars(void)
+{
+	free(sim.vars);
+	sim.vars = NULL;
+	sim.nvars = sim.vars_size = 0;
+}
+
+static int sim_load(const char *config, char *image, size_t image_size)
+{
+	char line[256], *p, *arg;
+	unsigned int lineno = 0;
+	FILE *fp;
+	int rc = 0;
+
+	fp = fopen(config, "r");
+	if (!fp) {
+		rc = -errno;
+		fprintf(stderr, "Cannot open simulation config '%s': %s\n", config,
+			strerror(-rc));
+		return rc;
+	}
+
+	while (rc == 0 && fgets(line, sizeof(line), fp)) {
+		lineno++;
+		p = strchr(line, '#');
+		if (p)
+			*p = '\0';
+		p = line + strspn(line, " \t");
+		arg = p + strcspn(p, " \t\n");
+		if (arg == p)
+			continue;
+		if (*arg)
+			*arg++ = '\0';
+		arg += strspn(arg, " \t");
+
+		if (!strcmp(p, "image")) {
+			arg[strcspn(arg, " \t\n")] = '\0';
+			if (!*arg || strlen(arg) >= image_size)
+				rc = -EINVAL;
+			else
+				strcpy(image, arg);
+		} else if (!strcmp(p, "device")) {
+			rc = sim_add_device(arg);
+		} else if (!strcmp(p, "var")) {
+			rc = sim_add_var(arg);
+		} else {
+			rc = -EINVAL;
+		}
+
+		if (rc < 0)
+			fprintf(stderr, "%s:%u: invalid '%s' entry: %s\n", config, lineno,
+				p, strerror(-rc));
+	}
+
+	fclose(fp);
+	return rc;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Open the simulated device
+ *
+ * @param[in]   config	path of the config file, empty for an image without
+ *			devices and variables
+ *
+ * @return handle of the simulated device, < 0 on error with errno set
+ *
+ ************************************************************************************/
+int piSimOpen(const char *config)
+{
+	char image[256] = "";
+	struct stat st;
+	void *map;
+	int fd, rc;
+
+	if (sim.fd >= 0) {
+		errno = EBUSY;
+		return -1;
+	}
+
+	sim.ndevs = 0;
+	sim.nvars = 0;
+	if (config && *config) {
+		rc = sim_load(config, image, sizeof(image));
+		if (rc < 0) {
+			free_vars();
+			errno = -rc;
+			return -1;
+		}
+	}
+
+	if (*image)
+		fd = open(image, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+	else
+		fd = memfd_create("piControl", MFD_CLOEXEC);
+	if (fd < 0) {
+		rc = errno;
+		free_vars();
+		errno = rc;
+		return -1;
+	}
+
+	if (fstat(fd, &st) < 0 || (st.st_size < KB_PI_LEN && ftruncate(fd, KB_PI_LEN) < 0))
+		goto err;
+
+	map = mmap(NULL, KB_PI_LEN, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED)
+		goto err;
+
+	sim.image = map;
+	sim.fd = fd;
+	sim.stop_io = 0;
+	return fd;
+
+err:
+	rc = errno;
+	close(fd);
+	free_vars();
+	errno = rc;
+	return -1;
+}
+
+void piSimClose(int fd)
+{
+	if (fd < 0 || fd != sim.fd)
+		return;
+
+	munmap(sim.image, KB_PI_LEN);
+	close(sim.fd);
+	sim.image = NULL;
+	sim.fd = -1;
+	free_vars();
+}
+
+ssize_t piSimRead(int fd, void *buf, size_t count, off_t offset)
+{
+	if (fd < 0 || fd != sim.fd) {
+		errno = EBADF;
+		return -1;
+	}
+	if (offset < 0 || offset >= KB_PI_LEN)
+		return 0;
+	if (count > (size_t)(KB_PI_LEN - offset))
+		count = KB_PI_LEN - offset;
+
+	pthread_mutex_lock(&sim.lock);
+	memcpy(buf, sim.image + offset, count);
+	pthread_mutex_unlock(&sim.lock);
+
+	return count;
+}
+
+ssize_t piSimWrite(int fd, const void *buf, size_t count, off_t offset)
+{
+	if (fd < 0 || fd != sim.fd) {
+		errno = EBADF;
+		return -1;
+	}
+	if (offset < 0 || offset >= KB_PI_LEN) {
+		errno = EFAULT;
+		return -1;
+	}
+	if (count > (size_t)(KB_PI_LEN - offset))
+		count = KB_PI_LEN - offset;
+
+	pthread_mutex_lock(&sim.lock);
+	memcpy(sim.image + offset, buf, count);
+	pthread_mutex_unlock(&sim.lock);
+
+	return count;
+}
+
+/* like the driver: by module type if one is given, by address otherwise */
+static SDeviceInfo *sim_find_device(uint8_t address, uint16_t type)
+{
+	int i;
+
+	for (i = 0; i < sim.ndevs; i++) {
+		if (type ? sim.devs[i].i16uModuleType == type : sim.devs[i].i8uAddress == address)
+			return &sim.devs[i];
+	}
+
+	return NULL;
+}
+
+static int sim_bit(SPIValue *val, bool set)
+{
+	uint8_t *p;
+
+	if (val->i16uAddress >= KB_PI_LEN || val->i8uBit > 7)
+		return -EFAULT;
+
+	p = sim.image + val->i16uAddress;
+	pthread_mutex_lock(&sim.lock);
+	if (set) {
+		if (val->i8uValue)
+			*p |= 1 << val->i8uBit;
+		else
+			*p &= ~(1 << val->i8uBit);
+	} else {
+		val->i8uValue = (*p >> val->i8uBit) & 1;
+	}
+	pthread_mutex_unlock(&sim.lock);
+
+	return 0;
+}
+
+static int sim_find_variable(SPIVariable *var)
+{
+	unsigned int i;
+
+	for (i = 0; i < sim.nvars; i++) {
+		if (!strncmp(sim.vars[i].strVarName, var->strVarName,
+			     sizeof(var->strVarName))) {
+			var->i16uAddress = sim.vars[i].i16uAddress;
+			var->i8uBit = sim.vars[i].i8uBit;
+			var->i16uLength = sim.vars[i].i16uLength;
+			return 0;
+		}
+	}
+
+	return -ENOENT;
+}
+
+static int sim_reset_counter(const SDIOResetCounter *tel)
+{
+	const SDeviceInfo *dev = sim_find_device(tel->i8uAddress, 0);
+	uint16_t type;
+	int i;
+
+	if (!dev)
+		return -EINVAL;
+	type = dev->i16uModuleType & PICONTROL_NOT_CONNECTED_MASK;
+	if (type != KUNBUS_FW_DESCR_TYP_PI_DIO_14 && type != KUNBUS_FW_DESCR_TYP_PI_DI_16)
+		return -EINVAL;
+
+	pthread_mutex_lock(&sim.lock);
+	for (i = 0; i < SIM_COUNTERS; i++) {
+		unsigned int pos = SIM_COUNTER_OFFSET + i * 4;
+
+		if (!(tel->i16uBitfield & (1 << i)) || pos + 4 > dev->i16uInputLength)
+			continue;
+		memset(sim.image + dev->i16uInputOffset + pos, 0, 4);
+	}
+	pthread_mutex_unlock(&sim.lock);
+
+	return 0;
+}
+
+static int sim_ro_counters(struct revpi_ro_ioctl_counters *ioc)
+{
+	const SDeviceInfo *dev = sim_find_device(ioc->addr, 0);
+
+	if (!dev || (dev->i16uModuleType & PICONTROL_NOT_CONNECTED_MASK) !=
+		    KUNBUS_FW_DESCR_TYP_PI_RO)
+		return -EINVAL;
+
+	memset(ioc->counter, 0, sizeof(ioc->counter));
+	return 0;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Emulate the ioctls of the piControl device
+ *
+ * Firmware update, calibration and waiting for events are not supported.
+ *
+ * @return like ioctl(), >= 0 on success, -1 with errno set on error
+ *
+ ************************************************************************************/
+int piSimIoctl(int fd, unsigned long request, void *arg)
+{
+	SDeviceInfo *dev;
+	int rc = 0;
+
+	if (fd < 0 || fd != sim.fd) {
+		errno = EBADF;
+		return -1;
+	}
+
+	switch (request) {
+	case KB_RESET:
+		break;
+	case KB_GET_DEVICE_INFO_LIST:
+		memcpy(arg, sim.devs, sim.ndevs * sizeof(*sim.devs));
+		rc = sim.ndevs;
+		break;
+	case KB_GET_DEVICE_INFO:
+		dev = sim_find_device(((SDeviceInfo *)arg)->i8uAddress,
+				      ((SDeviceInfo *)arg)->i16uModuleType);
+		if (dev)
+			memcpy(arg, dev, sizeof(*dev));
+		else
+			rc = -ENXIO;
+		break;
+	case KB_GET_VALUE:
+		rc = sim_bit(arg, false);
+		break;
+	case KB_SET_VALUE:
+		rc = sim_bit(arg, true);
+		break;
+	case KB_FIND_VARIABLE:
+		rc = sim_find_variable(arg);
+		break;
+	case KB_DIO_RESET_COUNTER:
+		rc = sim_reset_counter(arg);
+		break;
+	case KB_RO_GET_COUNTER:
+		rc = sim_ro_counters(arg);
+		break;
+	case KB_GET_LAST_MESSAGE:
+		*(char *)arg = '\0';
+		break;
+	case KB_STOP_IO:
+		sim.stop_io = *(int *)arg == 2 ? !sim.stop_io : !!*(int *)arg;
+		rc = sim.stop_io;
+		break;
+	default:
+		rc = -ENOTTY;
+		break;
+	}
+
+	if (rc < 0) {
+		errno = -rc;
+		return -1;
+	}
+
+	return rc;
+}
@@ -0,0 +1,304 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+/*!
+ * Project: piTest
+ * Demo source code for usage of piControl driver
+ *
+ * \file piCounter.c
+ *
+ * \brief Rates of the counters and encoders of DIO and DI modules
+ *
+ * The counters of all DIO and DI modules of the device list are sampled
+ * with one read per cycle. The differences between consecutive samples are
+ * summed up per window, as 32 bit differences, so counters wrapping around
+ * and encoders counting down are handled. At the end of every window the
+ * pulses and the rate are printed and the counters are optionally reset.
+ */
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "piControlIf.h"
+#include "piCounter.h"
+#include "piCycle.h"
+#include "piFormat.h"
+#include "piImage.h"
+
+/******************************************************************************/
+/*********************************  Types  ************************************/
+/******************************************************************************/
+
+/* counters in the input block of DIO and DI modules */
+#define COUNTER_OFFSET	6
+#define COUNTER_MAX	16
+
+struct counter_module {
+	uint8_t address;
+	uint32_t offset;		/* first counter in the process image */
+	unsigned int count;		/* number of counters in the input block */
+	unsigned int first;		/* first counter in the state arrays */
+};
+
+struct counter_state {
+	struct counter_module *modules;
+	unsigned int nmodules;
+	unsigned int count;		/* counters of all modules */
+	uint32_t *prev;			/* value of the previous sample */
+	int64_t *pulses;		/* pulses in the current window */
+};
+
+/******************************************************************************/
+/*******************************  Functions  **********************************/
+/******************************************************************************/
+
+static int find_modules(struct counter_state *st, struct pi_span *span)
+{
+	const SDeviceInfo *devs, *dev;
+	struct counter_module *mod;
+	uint16_t type;
+	int ndevs, i;
+
+	ndevs = piControlGetDeviceList(&devs);
+	if (ndevs < 0)
+		return ndevs;
+
+	st->modules = calloc(ndevs ? ndevs : 1, sizeof(*st->modules));
+	if (!st->modules) {
+		fprintf(stderr, "Not enough memory\n");
+		return -ENOMEM;
+	}
+
+	piSpanInit(span);
+	for (i = 0; i < ndevs; i++) {
+		dev = &devs[i];
+		type = dev->i16uModuleType & PICONTROL_NOT_CONNECTED_MASK;
+		if (type != KUNBUS_FW_DESCR_TYP_PI_DIO_14 && type != KUNBUS_FW_DESCR_TYP_PI_DI_16)
+			continue;
+		if (dev->i16uInputLength < COUNTER_OFFSET + 4)
+			continue;
+
+		mod = &st->modules[st->nmodules++];
+		mod->address = dev->i8uAddress;
+		mod->offset = dev->i16uInputOffset + COUNTER_OFFSET;
+		mod->count = (dev->i16uInputLength - COUNTER_OFFSET) / 4;
+		if (mod->count > COUNTER_MAX)
+			mod->count = COUNTER_MAX;
+		mod->first = st->count;
+		st->count += mod->count;
+		piSpanAdd(span, mod->offset, mod->count * 4);
+	}
+
+	if (st->nmodules == 0) {
+		fprintf(stderr, "No DIO or DI modules found\n");
+		return -ENODEV;
+	}
+
+	st->prev = calloc(st->count, sizeof(*st->prev));
+	st->pulses = calloc(st->count, sizeof(*st->pulses));
+	if (!st->prev || !st->pulses) {
+		fprintf(stderr, "Not enough memory\n");
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
+/* take the values of a sample, the pulses are summed up unless first is set */
+static void update(struct counter_state *st, const uint8_t *image, uint32_t base, bool first)
+{
+	const struct counter_module *mod;
+	unsigned int m, i, n;
+	uint32_t value;
+
+	for (m = 0; m < st->nmodules; m++) {
+		mod = &st->modules[m];
+		for (i = 0; i < mod->count; i++) {
+			n = mod->first + i;
+			value = piImageExtract(image + (mod->offset - base) + i * 4, 32, 0, false);
+			if (!first)
+				st->pulses[n] += (int32_t)(value - st->prev[n]);
+			st->prev[n] = value;
+		}
+	}
+}
+
+static const char *const counter_columns[] = {
+	"ts_ns", "address", "counter", "value", "pulses", "rate_hz",
+};
+
+static void print_header(struct pi_format *fmt)
+{
+	unsigned int i;
+
+	if (fmt->type == PI_FORMAT_TEXT) {
+		piFormatPrintf(fmt, "%-17s %7s %7s %11s %11s %14s\n", "time", "address",
+			       "counter", "value", "pulses", "rate_hz");
+		return;
+	}
+
+	for (i = 0; i < sizeof(counter_columns) / sizeof(counter_columns[0]); i++)
+		piFormatName(fmt, counter_columns[i]);
+	piFormatEnd(fmt);
+}
+
+/* print the pulses and rates of a window, timestamp is the wall clock time in ns */
+static void print_window(const struct counter_state *st, struct pi_format *fmt,
+			 uint64_t timestamp, uint64_t duration)
+{
+	const struct counter_module *mod;
+	unsigned int m, i, n;
+	double rate;
+
+	for (m = 0; m < st->nmodules; m++) {
+		mod = &st->modules[m];
+		for (i = 0; i < mod->count; i++) {
+			n = mod->first + i;
+			rate = duration ? st->pulses[n] * 1e9 / duration : 0;
+
+			if (fmt->type == PI_FORMAT_TEXT) {
+				piFormatPrintf(fmt, "%10" PRIu64 ".%06" PRIu64 " %7u %7u %11" PRIu32
+					       " %11" PRId64 " %14.3f\n", timestamp / 1000000000,
+					       (timestamp % 1000000000) / 1000, mod->address, i + 1,
+					       st->prev[n], st->pulses[n], rate);
+				continue;
+			}
+
+			piFormatKey(fmt, "ts_ns");
+			piFormatUint(fmt, timestamp);
+			piFormatKey(fmt, "address");
+			piFormatUint(fmt, mod->address);
+			piFormatKey(fmt, "counter");
+			piFormatUint(fmt, i + 1);
+			piFormatKey(fmt, "value");
+			piFormatUint(fmt, st->prev[n]);
+			piFormatKey(fmt, "pulses");
+			piFormatInt(fmt, st->pulses[n]);
+			piFormatKey(fmt, "rate_hz");
+			piFormatDouble(fmt, "%.3f", rate);
+			piFormatEnd(fmt);
+		}
+	}
+}
+
+/* reset the counters of all modules, the next window starts at 0 */
+static int reset(struct counter_state *st)
+{
+	const struct counter_module *mod;
+	unsigned int m;
+	int rc;
+
+	for (m = 0; m < st->nmodules; m++) {
+		mod = &st->modules[m];
+		rc = piControlResetCounter(mod->address, (1U << mod->count) - 1);
+		if (rc < 0)
+			return rc;
+		memset(st->prev + mod->first, 0, mod->count * sizeof(*st->prev));
+	}
+
+	return 0;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Print the rates of the counters of all DIO and DI modules
+ *
+ * All counters are read with one read per period. At the end of every
+ * window the value, the pulses within the window and the rate in Hz of
+ * every counter are printed. With reset set the counters are reset after
+ * the read ending a window; pulses between this read and the reset are not
+ * counted.
+ *
+ * @param[in]   args	parameters of the sampling
+ *
+ * @return 0 on success, < 0 on error
+ *
+ ************************************************************************************/
+int piCounterRun(const struct pi_counter_args *args)
+{
+	struct counter_state st = { 0 };
+	struct pi_format *fmt = NULL;
+	uint64_t window_ns = args->window_ms * 1000000ULL, start = 0, ts;
+	struct pi_cycle cycle;
+	struct pi_span span;
+	uint8_t *image = NULL;
+	int64_t wall_offset;
+	bool first = true;
+	int rc;
+
+	rc = piFormatTextual(args->type);
+	if (rc < 0)
+		return rc;
+
+	rc = find_modules(&st, &span);
+	if (rc < 0)
+		goto out;
+
+	image = malloc(span.length);
+	fmt = malloc(sizeof(*fmt));
+	if (!image || !fmt) {
+		fprintf(stderr, "Not enough memory\n");
+		rc = -ENOMEM;
+		goto out;
+	}
+
+	if (args->reset) {
+		rc = reset(&st);
+		if (rc < 0)
+			goto out;
+	}
+
+	piFormatInit(fmt, args->type, STDOUT_FILENO, NULL, 0);
+	print_header(fmt);
+	wall_offset = piImageWallclock() - piImageTimestamp();
+	rc = piCycleStart(&cycle, args->period_us);
+	if (rc < 0)
+		goto out;
+
+	do {
+		if (piControlRead(span.offset, span.length, image) < 0)
+			continue;
+		ts = piImageTimestamp();
+		update(&st, image, span.offset, first && !args->reset);
+		if (first)
+			start = ts;
+		first = false;
+
+		if (ts - start < window_ns)
+			continue;
+
+		print_window(&st, fmt, ts + wall_offset, ts - start);
+		rc = piFormatFlush(fmt);
+		if (rc < 0 || args->once)
+			break;
+
+		if (args->reset) {
+			rc = reset(&st);
+			if (rc < 0)
+				break;
+		}
+		memset(st.pulses, 0, st.count * sizeof(*st.pulses));
+		start = ts;
+	} while (piCycleWait(&cycle));
+
+	piCycleFinish(&cycle);
+	if (piFormatFinish(fmt) < 0 && rc == 0)
+		rc = fmt->error;
+
+out:
+	free(fmt);
+	free(image);
+	free(st.pulses);
+	free(st.prev);
+	free(st.modules);
+	return rc;
+}
@@ -0,0 +1,256 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+/*!
+ * Project: piTest
+ * Demo source code for usage of piControl driver
+ *
+ * \file piCycle.c
+ *
+ * \brief Timing of cyclic modes
+ *
+ * Cycles are released at absolute times, so that the time spent in a cycle
+ * does not shift the following ones. Optionally a realtime profile is
+ * applied before the first cycle.
+ */
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <inttypes.h>
+#include <malloc.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "piCycle.h"
+
+/* stack which is touched once, so that cycles do not fault it in */
+#define RT_STACK_PREFAULT	(256 * 1024)
+
+/******************************************************************************/
+/******************************  Global Vars  *********************************/
+/******************************************************************************/
+
+static volatile sig_atomic_t stop_requested;
+
+static struct {
+	bool requested;
+	bool applied;
+	int priority;
+	int cpu;
+} rt_profile = { .cpu = -1 };
+
+/******************************************************************************/
+/*******************************  Functions  **********************************/
+/******************************************************************************/
+
+/***********************************************************************************/
+/*!
+ * @brief Request a realtime profile for the following cyclic modes
+ *
+ * @param[in]   priority	SCHED_FIFO priority
+ * @param[in]   cpu		CPU to run on, < 0 to keep the affinity
+ *
+ ************************************************************************************/
+void piCycleSetRealtime(int priority, int cpu)
+{
+	rt_profile.requested = true;
+	rt_profile.priority = priority;
+	rt_profile.cpu = cpu;
+}
+
+static void prefault_stack(void)
+{
+	volatile uint8_t stack[RT_STACK_PREFAULT];
+
+	memset((uint8_t *)stack, 0, sizeof(stack));
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Apply the realtime profile
+ *
+ * Sets the scheduling policy and affinity, locks all current and future
+ * memory, keeps freed heap memory in the process and prefaults the stack.
+ *
+ * @return 0 on success, < 0 on error
+ *
+ ************************************************************************************/
+static int apply_realtime(void)
+{
+	struct sched_param param;
+	cpu_set_t cpus;
+
+	if (rt_profile.cpu >= 0) {
+		CPU_ZERO(&cpus);
+		CPU_SET(rt_profile.cpu, &cpus);
+		if (sched_setaffinity(0, sizeof(cpus), &cpus) < 0) {
+			fprintf(stderr, "Failed to set CPU affinity to %d: %s\n",
+				rt_profile.cpu, strerror(errno));
+			return -errno;
+		}
+	}
+
+	memset(&param, 0, sizeof(param));
+	param.sched_priority = rt_profile.priority;
+	if (sched_setscheduler(0, SCHED_FIFO, &param) < 0) {
+		fprintf(stderr, "Failed to set SCHED_FIFO priority %d: %s\n",
+			rt_profile.priority, strerror(errno));
+		return -errno;
+	}
+
+	if (mlockall(MCL_CURRENT | MCL_FUTURE) < 0) {
+		fprintf(stderr, "Failed to lock memory: %s\n", strerror(errno));
+		return -errno;
+	}
+
+	mallopt(M_TRIM_THRESHOLD, -1);
+	mallopt(M_MMAP_MAX, 0);
+	prefault_stack();
+
+	rt_profile.applied = true;
+
+	return 0;
+}
+
+static void stop_handler(int sig)
+{
+	(void)sig;
+	stop_requested = 1;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Catch SIGINT and SIGTERM
+ *
+ * After this piCycleStopped() reports whether the mode was asked to stop.
+ * Used by loops which do not run on a fixed cycle.
+ *
+ ************************************************************************************/
+void piCycleCatchSignals(void)
+{
+	struct sigaction sa;
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = stop_handler;
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Prepare the timing of a cyclic mode
+ *
+ * Applies the realtime profile if requested and catches SIGINT and SIGTERM,
+ * so that the mode can end its loop and report its statistics.
+ *
+ * @param[out]  cycle		timing state
+ * @param[in]   period_us	cycle time in microseconds
+ *
+ * @return 0 on success, < 0 on error
+ *
+ ************************************************************************************/
+int piCycleStart(struct pi_cycle *cycle, uint32_t period_us)
+{
+	int rc;
+
+	if (rt_profile.requested && !rt_profile.applied) {
+		rc = apply_realtime();
+		if (rc < 0)
+			return rc;
+	}
+
+	piCycleCatchSignals();
+
+	memset(cycle, 0, sizeof(*cycle));
+	cycle->period_ns = (uint64_t)period_us * 1000;
+	clock_gettime(CLOCK_MONOTONIC, &cycle->next);
+
+	return 0;
+}
+
+static uint64_t ts_ns(const struct timespec *ts)
+{
+	return (uint64_t)ts->tv_sec * 1000000000ULL + ts->tv_nsec;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Wait for the release of the next cycle
+ *
+ * A cycle which ends after the release time of the next one counts as a
+ * deadline miss. The schedule is then restarted from the current time instead
+ * of running the missed cycles back to back.
+ *
+ * @return false if the mode was asked to stop
+ *
+ ************************************************************************************/
+bool piCycleWait(struct pi_cycle *cycle)
+{
+	struct timespec now;
+	uint64_t next_ns, now_ns;
+
+	cycle->cycles++;
+	if (stop_requested)
+		return false;
+
+	next_ns = ts_ns(&cycle->next) + cycle->period_ns;
+	cycle->next.tv_sec = next_ns / 1000000000ULL;
+	cycle->next.tv_nsec = next_ns % 1000000000ULL;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	if (ts_ns(&now) > next_ns) {
+		cycle->misses++;
+		cycle->next = now;
+		return !stop_requested;
+	}
+
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &cycle->next, NULL) == EINTR) {
+		if (stop_requested)
+			return false;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	now_ns = ts_ns(&now);
+	if (now_ns > next_ns) {
+		cycle->latency_sum_ns += now_ns - next_ns;
+		if (now_ns - next_ns > cycle->latency_max_ns)
+			cycle->latency_max_ns = now_ns - next_ns;
+	}
+
+	return !stop_requested;
+}
+
+bool piCycleStopped(void)
+{
+	return stop_requested;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Report the timing statistics of a cyclic mode
+ *
+ * The report is printed to stderr if a realtime profile was applied.
+ *
+ ************************************************************************************/
+void piCycleFinish(const struct pi_cycle *cycle)
+{
+	uint64_t waits;
+
+	if (!rt_profile.applied)
+		return;
+
+	waits = cycle->cycles - cycle->misses;
+	fprintf(stderr, "cycles: %" PRIu64 " deadline misses: %" PRIu64
+		" wakeup latency max: %" PRIu64 " us avg: %" PRIu64 " us\n",
+		cycle->cycles, cycle->misses, cycle->latency_max_ns / 1000,
+		waits ? cycle->latency_sum_ns / waits / 1000 : 0);
+}
@@ -0,0 +1,802 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+/*!
+ * Project: piTest
+ * Demo source code for usage of piControl driver
+ *
+ * \file piFormat.c
+ *
+ * \brief Machine readable output of samples
+ *
+ * Samples of the process image are serialized as NDJSON, CSV, binary
+ * recording or compressed capture. All output is put together in a buffer
+ * that is part of the serializer and written to the file descriptor when it
+ * is full or on request, so no memory is allocated and no stdio is involved
+ * per sample.
+ *
+ * Modes printing other records than samples, like statistics, put their
+ * NDJSON and CSV records together field by field, see piFormatKey().
+ */
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "piFormat.h"
+
+/******************************************************************************/
+/*******************************  Functions  **********************************/
+/******************************************************************************/
+
+/* make room for n bytes in the buffer, n must not exceed its size */
+static char *reserve(struct pi_format *fmt, size_t n)
+{
+	if (fmt->used + n > sizeof(fmt->buffer))
+		piFormatFlush(fmt);
+
+	return fmt->buffer + fmt->used;
+}
+
+static void put_char(struct pi_format *fmt, char c)
+{
+	*reserve(fmt, 1) = c;
+	fmt->used++;
+}
+
+static void put_bytes(struct pi_format *fmt, const void *data, size_t len)
+{
+	const uint8_t *p = data;
+
+	while (len) {
+		size_t n = len < sizeof(fmt->buffer) ? len : sizeof(fmt->buffer);
+
+		memcpy(reserve(fmt, n), p, n);
+		fmt->used += n;
+		p += n;
+		len -= n;
+	}
+}
+
+static void put_str(struct pi_format *fmt, const char *s)
+{
+	put_bytes(fmt, s, strlen(s));
+}
+
+static void put_u64(struct pi_format *fmt, uint64_t value)
+{
+	char digits[20];
+	int i = sizeof(digits);
+
+	do {
+		digits[--i] = '0' + value % 10;
+		value /= 10;
+	} while (value);
+
+	put_bytes(fmt, digits + i, sizeof(digits) - i);
+}
+
+static void put_i64(struct pi_format *fmt, int64_t value)
+{
+	if (value < 0) {
+		put_char(fmt, '-');
+		put_u64(fmt, -(uint64_t)value);
+	} else {
+		put_u64(fmt, value);
+	}
+}
+
+static void put_le(struct pi_format *fmt, uint64_t value, unsigned int bytes)
+{
+	char *p = reserve(fmt, bytes);
+	unsigned int i;
+
+	for (i = 0; i < bytes; i++)
+		p[i] = value >> (8 * i);
+	fmt->used += bytes;
+}
+
+static void put_json_string(struct pi_format *fmt, const char *s)
+{
+	static const char hex[] = "0123456789abcdef";
+
+	put_char(fmt, '"');
+	for (; *s; s++) {
+		unsigned char c = *s;
+
+		if (c == '"' || c == '\\') {
+			put_char(fmt, '\\');
+			put_char(fmt, c);
+		} else if (c < 0x20) {
+			put_str(fmt, "\\u00");
+			put_char(fmt, hex[c >> 4]);
+			put_char(fmt, hex[c & 0xf]);
+		} else {
+			put_char(fmt, c);
+		}
+	}
+	put_char(fmt, '"');
+}
+
+static void put_csv_field(struct pi_format *fmt, const char *s)
+{
+	if (!strpbrk(s, ",\"\r\n")) {
+		put_str(fmt, s);
+		return;
+	}
+
+	put_char(fmt, '"');
+	for (; *s; s++) {
+		if (*s == '"')
+			put_char(fmt, '"');
+		put_char(fmt, *s);
+	}
+	put_char(fmt, '"');
+}
+
+static void put_varint(struct pi_format *fmt, uint64_t value)
+{
+	fmt->used += piCapPutVarint((uint8_t *)reserve(fmt, 10), value);
+}
+
+/* position in the output of the next byte */
+static uint64_t position(const struct pi_format *fmt)
+{
+	return fmt->written + fmt->used;
+}
+
+/*
+ * Encode the changes between two samples as pairs of unchanged and changed
+ * byte counts, followed by the changed bytes XOR the previous ones. Two
+ * unchanged bytes end a run of changed bytes, a single one is cheaper to
+ * include. Unchanged bytes are skipped a word at a time.
+ *
+ * Returns the size of the encoding, or 0 if it would exceed limit.
+ */
+static size_t cap_delta(uint8_t *out, const uint8_t *prev, const uint8_t *cur,
+			size_t length, size_t limit)
+{
+	size_t i = 0, n = 0, start, changed;
+	uint64_t a, b;
+
+	while (i < length) {
+		start = i;
+		while (i + 8 <= length) {
+			memcpy(&a, prev + i, 8);
+			memcpy(&b, cur + i, 8);
+			if (a != b)
+				break;
+			i += 8;
+		}
+		while (i < length && prev[i] == cur[i])
+			i++;
+		if (i == length)
+			break;
+
+		changed = i;
+		while (i < length && (prev[i] != cur[i] ||
+				      (i + 1 < length && prev[i + 1] != cur[i + 1])))
+			i++;
+
+		/* 20 bytes for the two varints */
+		if (n + 20 + (i - changed) > limit)
+			return 0;
+		n += piCapPutVarint(out + n, changed - start);
+		n += piCapPutVarint(out + n, i - changed);
+		for (; changed < i; changed++)
+			out[n++] = prev[changed] ^ cur[changed];
+	}
+
+	return n;
+}
+
+/* write the keyframes since the last index record */
+static void cap_index(struct pi_format *fmt)
+{
+	uint64_t pos = position(fmt);
+	unsigned int i;
+
+	if (fmt->keyframes == 0)
+		return;
+
+	put_char(fmt, PI_CAP_INDEX);
+	put_varint(fmt, 12 + 16 * fmt->keyframes);
+	put_le(fmt, fmt->index_pos, 8);
+	put_le(fmt, fmt->keyframes, 4);
+	for (i = 0; i < fmt->keyframes; i++) {
+		put_le(fmt, fmt->index[i].timestamp, 8);
+		put_le(fmt, fmt->index[i].pos, 8);
+	}
+	fmt->index_pos = pos;
+	fmt->keyframes = 0;
+}
+
+/*
+ * Write a sample as change record, or as keyframe if it is the first one,
+ * the last keyframe is older than PI_CAP_KEYFRAME_MS or the changes would
+ * not be smaller.
+ */
+static void cap_sample(struct pi_format *fmt, uint64_t timestamp, const uint8_t *data)
+{
+	uint8_t ts[10];
+	size_t n = 0, ts_len = 0;
+	bool key;
+
+	key = fmt->samples == 0 ||
+	      timestamp - fmt->key_timestamp >= PI_CAP_KEYFRAME_MS * 1000000ULL;
+	if (!key) {
+		ts_len = piCapPutVarint(ts, timestamp - fmt->prev_timestamp);
+		n = cap_delta(fmt->delta, fmt->prev, data, fmt->length, fmt->length);
+		/* an unchanged sample has an empty encoding */
+		key = n == 0 && memcmp(fmt->prev, data, fmt->length);
+	}
+
+	if (key) {
+		fmt->index[fmt->keyframes].timestamp = timestamp;
+		fmt->index[fmt->keyframes].pos = position(fmt);
+		fmt->keyframes++;
+		fmt->key_timestamp = timestamp;
+
+		put_char(fmt, PI_CAP_KEYFRAME);
+		put_varint(fmt, 8 + fmt->length);
+		put_le(fmt, timestamp, 8);
+		put_bytes(fmt, data, fmt->length);
+		if (fmt->keyframes == PI_CAP_INDEX_ENTRIES)
+			cap_index(fmt);
+	} else {
+		put_char(fmt, PI_CAP_DELTA);
+		put_varint(fmt, ts_len + n);
+		put_bytes(fmt, ts, ts_len);
+		put_bytes(fmt, fmt->delta, n);
+	}
+
+	memcpy(fmt->prev, data, fmt->length);
+	fmt->prev_timestamp = timestamp;
+	fmt->samples++;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Look up an output format by name
+ *
+ * @param[in]   name	"text", "ndjson", "csv", "bin" or "cap"
+ *
+ * @return the format, -EINVAL if the name is unknown
+ *
+ ************************************************************************************/
+int piFormatType(const char *name)
+{
+	if (!strcmp(name, "text"))
+		return PI_FORMAT_TEXT;
+	if (!strcmp(name, "ndjson"))
+		return PI_FORMAT_NDJSON;
+	if (!strcmp(name, "csv"))
+		return PI_FORMAT_CSV;
+	if (!strcmp(name, "bin"))
+		return PI_FORMAT_BIN;
+	if (!strcmp(name, "cap"))
+		return PI_FORMAT_CAP;
+
+	return -EINVAL;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Initialize a serializer
+ *
+ * A sample passed to piFormatSample() holds the bytes of the process image
+ * spanned by all variables. The serializer has to be finished with
+ * piFormatFinish().
+ *
+ * @param[in]   fmt	serializer
+ * @param[in]   type	output format
+ * @param[in]   fd	file descriptor to write to
+ * @param[in]   vars	variables of a sample, referenced until the serializer
+ *			is no longer used
+ * @param[in]   count	number of variables
+ *
+ * @return 0 on success, < 0 on error
+ *
+ ************************************************************************************/
+int piFormatInit(struct pi_format *fmt, enum pi_format_type type, int fd,
+		 const struct pi_var *vars, unsigned int count)
+{
+	struct pi_span span;
+	unsigned int i;
+
+	piSpanInit(&span);
+	for (i = 0; i < count; i++)
+		piSpanAdd(&span, vars[i].offset, piImageVarBytes(&vars[i]));
+
+	/* output of stdio pending for the same file comes first */
+	if (fd == STDOUT_FILENO)
+		fflush(stdout);
+
+	fmt->type = type;
+	fmt->fd = fd;
+	fmt->vars = vars;
+	fmt->count = count;
+	fmt->offset = span.offset;
+	fmt->length = span.length;
+	fmt->wall_offset = piImageWallclock() - piImageTimestamp();
+	fmt->error = 0;
+	fmt->written = 0;
+	fmt->prev = NULL;
+	fmt->delta = NULL;
+	fmt->samples = 0;
+	fmt->index_pos = 0;
+	fmt->keyframes = 0;
+	fmt->fields = 0;
+	fmt->used = 0;
+
+	if (type == PI_FORMAT_CAP) {
+		fmt->prev = malloc(fmt->length);
+		/* a change record is never longer than a keyframe, see cap_delta() */
+		fmt->delta = malloc(fmt->length + 32);
+		if (!fmt->prev || !fmt->delta) {
+			fprintf(stderr, "Not enough memory\n");
+			free(fmt->prev);
+			free(fmt->delta);
+			return -ENOMEM;
+		}
+	}
+
+	return 0;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Write what precedes the first sample
+ *
+ * @return 0 on success, < 0 if writing failed
+ *
+ ************************************************************************************/
+int piFormatHeader(struct pi_format *fmt)
+{
+	unsigned int i;
+
+	switch (fmt->type) {
+	case PI_FORMAT_CSV:
+		put_str(fmt, "ts_ns");
+		for (i = 0; i < fmt->count; i++) {
+			put_char(fmt, ',');
+			put_csv_field(fmt, fmt->vars[i].name);
+		}
+		put_char(fmt, '\n');
+		break;
+	case PI_FORMAT_BIN:
+	case PI_FORMAT_CAP:
+		if (fmt->type == PI_FORMAT_BIN) {
+			put_bytes(fmt, PI_REC_MAGIC, 8);
+			put_le(fmt, PI_REC_VERSION, 2);
+		} else {
+			put_bytes(fmt, PI_CAP_MAGIC, 8);
+			put_le(fmt, PI_CAP_VERSION, 2);
+		}
+		put_le(fmt, fmt->count, 2);
+		put_le(fmt, fmt->offset, 4);
+		put_le(fmt, fmt->length, 4);
+		put_le(fmt, fmt->type == PI_FORMAT_CAP ? PI_CAP_KEYFRAME_MS : 0, 4);
+		for (i = 0; i < fmt->count; i++) {
+			char name[PI_REC_NAME_LEN] = { 0 };
+
+			memcpy(name, fmt->vars[i].name,
+			       strnlen(fmt->vars[i].name, sizeof(name) - 1));
+			put_bytes(fmt, name, sizeof(name));
+			put_le(fmt, fmt->vars[i].offset, 2);
+			put_le(fmt, fmt->vars[i].length, 2);
+			put_le(fmt, fmt->vars[i].bit, 1);
+			put_le(fmt, fmt->vars[i].is_signed, 1);
+			put_le(fmt, 0, 2);
+		}
+		break;
+	default:
+		break;
+	}
+
+	return fmt->error;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Serialize a sample
+ *
+ * @param[in]   fmt		serializer
+ * @param[in]   timestamp	monotonic timestamp of the sample in ns
+ * @param[in]   data		bytes of the process image, see piFormatInit()
+ *
+ * @return 0 on success, < 0 if writing failed
+ *
+ ************************************************************************************/
+int piFormatSample(struct pi_format *fmt, uint64_t timestamp, const uint8_t *data)
+{
+	uint64_t wallclock = timestamp + fmt->wall_offset;
+	unsigned int i;
+
+	switch (fmt->type) {
+	case PI_FORMAT_NDJSON:
+		put_str(fmt, "{\"ts_ns\":");
+		put_u64(fmt, wallclock);
+		for (i = 0; i < fmt->count; i++) {
+			put_char(fmt, ',');
+			put_json_string(fmt, fmt->vars[i].name);
+			put_char(fmt, ':');
+			put_i64(fmt, piImageValue(data, fmt->offset, &fmt->vars[i]));
+		}
+		put_str(fmt, "}\n");
+		break;
+	case PI_FORMAT_CSV:
+		put_u64(fmt, wallclock);
+		for (i = 0; i < fmt->count; i++) {
+			put_char(fmt, ',');
+			put_i64(fmt, piImageValue(data, fmt->offset, &fmt->vars[i]));
+		}
+		put_char(fmt, '\n');
+		break;
+	case PI_FORMAT_BIN:
+		put_le(fmt, wallclock, 8);
+		put_bytes(fmt, data, fmt->length);
+		break;
+	case PI_FORMAT_CAP:
+		cap_sample(fmt, wallclock, data);
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	return fmt->error;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Write the buffered output
+ *
+ * @return 0 on success, < 0 if this or an earlier write failed
+ *
+ ************************************************************************************/
+int piFormatFlush(struct pi_format *fmt)
+{
+	size_t done = 0;
+	ssize_t n;
+
+	while (!fmt->error && done < fmt->used) {
+		n = write(fmt->fd, fmt->buffer + done, fmt->used - done);
+		if (n < 0 && errno != EINTR)
+			fmt->error = -errno;
+		else if (n > 0)
+			done += n;
+	}
+	/* after an error the output is dropped */
+	fmt->written += fmt->used;
+	fmt->used = 0;
+
+	return fmt->error;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Write what follows the last sample and the buffered output
+ *
+ * Releases the resources of the serializer.
+ *
+ * @return 0 on success, < 0 if writing failed
+ *
+ ************************************************************************************/
+int piFormatFinish(struct pi_format *fmt)
+{
+	if (fmt->type == PI_FORMAT_CAP) {
+		cap_index(fmt);
+		put_char(fmt, PI_CAP_END);
+		put_varint(fmt, PI_CAP_END_SIZE - 2);
+		put_le(fmt, fmt->index_pos, 8);
+		put_le(fmt, fmt->samples, 8);
+		put_bytes(fmt, PI_CAP_END_MAGIC, 8);
+	}
+
+	free(fmt->prev);
+	free(fmt->delta);
+	fmt->prev = NULL;
+	fmt->delta = NULL;
+
+	return piFormatFlush(fmt);
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Check for a text based format
+ *
+ * Modes printing records instead of samples support text, NDJSON and CSV.
+ *
+ * @param[in]   type	output format
+ *
+ * @return 0 if the format is supported, -EINVAL otherwise
+ *
+ ************************************************************************************/
+int piFormatTextual(int type)
+{
+	if (type == PI_FORMAT_TEXT || type == PI_FORMAT_NDJSON || type == PI_FORMAT_CSV)
+		return 0;
+
+	fprintf(stderr, "Only the text, ndjson and csv formats are supported\n");
+	return -EINVAL;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Put formatted text into the output
+ *
+ * Used for the text format of the modes, so that all their output goes
+ * through the buffer of the serializer.
+ *
+ ************************************************************************************/
+void piFormatPrintf(struct pi_format *fmt, const char *spec, ...)
+{
+	size_t room = sizeof(fmt->buffer) - fmt->used;
+	va_list ap;
+	char *tmp;
+	int n;
+
+	va_start(ap, spec);
+	n = vsnprintf(fmt->buffer + fmt->used, room, spec, ap);
+	va_end(ap);
+	if (n < 0 || (size_t)n < room) {
+		fmt->used += n > 0 ? n : 0;
+		return;
+	}
+
+	if ((size_t)n < sizeof(fmt->buffer)) {
+		piFormatFlush(fmt);
+		va_start(ap, spec);
+		vsnprintf(fmt->buffer, sizeof(fmt->buffer), spec, ap);
+		va_end(ap);
+		fmt->used = n;
+		return;
+	}
+
+	/* longer than the whole buffer */
+	tmp = malloc(n + 1);
+	if (!tmp)
+		return;
+	va_start(ap, spec);
+	vsnprintf(tmp, n + 1, spec, ap);
+	va_end(ap);
+	put_bytes(fmt, tmp, n);
+	free(tmp);
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Add a column to the CSV header
+ *
+ * Does nothing in other formats. The header line is ended by piFormatEnd().
+ *
+ ************************************************************************************/
+void piFormatName(struct pi_format *fmt, const char *name)
+{
+	if (fmt->type != PI_FORMAT_CSV)
+		return;
+
+	if (fmt->fields++)
+		put_char(fmt, ',');
+	put_csv_field(fmt, name);
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Start the next field of a record
+ *
+ * In NDJSON the name is the key of the field, CSV only separates the
+ * fields. The value follows with one of piFormatString(), piFormatInt(),
+ * piFormatUint(), piFormatDouble(), piFormatBool() or piFormatNull().
+ *
+ ************************************************************************************/
+void piFormatKey(struct pi_format *fmt, const char *name)
+{
+	if (fmt->type == PI_FORMAT_NDJSON) {
+		put_char(fmt, fmt->fields++ ? ',' : '{');
+		put_json_string(fmt, name);
+		put_char(fmt, ':');
+	} else if (fmt->type == PI_FORMAT_CSV && fmt->fields++) {
+		put_char(fmt, ',');
+	}
+}
+
+void piFormatString(struct pi_format *fmt, const char *value)
+{
+	if (fmt->type == PI_FORMAT_NDJSON)
+		put_json_string(fmt, value);
+	else if (fmt->type == PI_FORMAT_CSV)
+		put_csv_field(fmt, value);
+}
+
+void piFormatInt(struct pi_format *fmt, int64_t value)
+{
+	put_i64(fmt, value);
+}
+
+void piFormatUint(struct pi_format *fmt, uint64_t value)
+{
+	put_u64(fmt, value);
+}
+
+/* value printed with the printf conversion spec, e.g. "%.3f", null if not finite */
+void piFormatDouble(struct pi_format *fmt, const char *spec, double value)
+{
+	char buf[64];
+	int n;
+
+	if (!isfinite(value)) {
+		piFormatNull(fmt);
+		return;
+	}
+
+	n = snprintf(buf, sizeof(buf), spec, value);
+	if (n > 0)
+		put_bytes(fmt, buf, (size_t)n < sizeof(buf) ? (size_t)n : sizeof(buf) - 1);
+}
+
+void piFormatBool(struct pi_format *fmt, bool value)
+{
+	if (fmt->type == PI_FORMAT_NDJSON)
+		put_str(fmt, value ? "true" : "false");
+	else
+		put_char(fmt, value ? '1' : '0');
+}
+
+/* null in NDJSON, an empty field in CSV */
+void piFormatNull(struct pi_format *fmt)
+{
+	if (fmt->type == PI_FORMAT_NDJSON)
+		put_str(fmt, "null");
+}
+
+/***********************************************************************************/
+/*!
+ * @brief End a record or the CSV header
+ *
+ * @return 0 on success, < 0 if writing failed
+ *
+ ************************************************************************************/
+int piFormatEnd(struct pi_format *fmt)
+{
+	if (fmt->fields) {
+		if (fmt->type == PI_FORMAT_NDJSON)
+			put_char(fmt, '}');
+		put_char(fmt, '\n');
+		fmt->fields = 0;
+	}
+
+	return fmt->error;
+}
+
+static uint64_t get_le(const uint8_t *p, unsigned int bytes)
+{
+	uint64_t value = 0;
+
+	while (bytes--)
+		value = value << 8 | p[bytes];
+	return value;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Open a binary recording or capture
+ *
+ * The file is mapped, a trailing incomplete sample of a recording is
+ * ignored.
+ *
+ * @param[in]   path	file written with --format bin or cap
+ * @param[out]  rec	opened recording
+ *
+ * @return 0 on success, < 0 on error
+ *
+ ************************************************************************************/
+int piRecOpen(const char *path, struct pi_rec *rec)
+{
+	const size_t header_size = 24, var_size = 40;
+	const uint8_t *p;
+	struct stat st;
+	size_t start;
+	unsigned int i;
+	void *map;
+	int fd, rc;
+
+	memset(rec, 0, sizeof(*rec));
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0 || fstat(fd, &st) < 0) {
+		rc = -errno;
+		fprintf(stderr, "Cannot open %s: %s\n", path, strerror(errno));
+		if (fd >= 0)
+			close(fd);
+		return rc;
+	}
+	if ((size_t)st.st_size < header_size) {
+		fprintf(stderr, "%s is no recording\n", path);
+		close(fd);
+		return -EINVAL;
+	}
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	rc = -errno;
+	close(fd);
+	if (map == MAP_FAILED) {
+		fprintf(stderr, "Cannot map %s: %s\n", path, strerror(-rc));
+		return rc;
+	}
+	rec->map = map;
+	rec->size = st.st_size;
+
+	p = rec->map;
+	rec->capture = !memcmp(p, PI_CAP_MAGIC, 8);
+	if (rec->capture ? get_le(p + 8, 2) != PI_CAP_VERSION :
+	    memcmp(p, PI_REC_MAGIC, 8) || get_le(p + 8, 2) != PI_REC_VERSION) {
+		fprintf(stderr, "%s is no recording of a supported version\n", path);
+		goto err;
+	}
+	rec->count = get_le(p + 10, 2);
+	rec->offset = get_le(p + 12, 4);
+	rec->length = get_le(p + 16, 4);
+	start = header_size + rec->count * var_size;
+	if (rec->size < start || rec->offset + rec->length > KB_PI_LEN) {
+		fprintf(stderr, "%s: invalid header\n", path);
+		goto err;
+	}
+
+	rec->vars = calloc(rec->count ? rec->count : 1, sizeof(*rec->vars));
+	if (!rec->vars) {
+		fprintf(stderr, "Not enough memory\n");
+		piRecClose(rec);
+		return -ENOMEM;
+	}
+	for (i = 0; i < rec->count; i++) {
+		struct pi_var *var = &rec->vars[i];
+
+		p = rec->map + header_size + i * var_size;
+		/* names are NUL padded to PI_REC_NAME_LEN */
+		memcpy(var->name, p, strnlen((const char *)p, sizeof(var->name) - 1));
+		var->offset = get_le(p + PI_REC_NAME_LEN, 2);
+		var->length = get_le(p + PI_REC_NAME_LEN + 2, 2);
+		var->bit = p[PI_REC_NAME_LEN + 4] & 7;
+		var->is_signed = p[PI_REC_NAME_LEN + 5];
+		if ((var->length != 1 && var->length != 8 && var->length != 16 &&
+		     var->length != 32) || var->offset < rec->offset ||
+		    var->offset + piImageVarBytes(var) > rec->offset + rec->length) {
+			fprintf(stderr, "%s: invalid variable %u\n", path, i);
+			goto err;
+		}
+	}
+
+	rec->records = rec->map + start;
+	/* the records of a capture are decoded by piCapture */
+	if (rec->capture)
+		return 0;
+	rec->samples = (rec->size - start) / (8 + rec->length);
+	if ((rec->size - start) % (8 + rec->length))
+		fprintf(stderr, "%s: ignoring incomplete last sample\n", path);
+
+	return 0;
+
+err:
+	piRecClose(rec);
+	return -EINVAL;
+}
+
+void piRecClose(struct pi_rec *rec)
+{
+	if (rec->map)
+		munmap((void *)rec->map, rec->size);
+	free(rec->vars);
+	memset(rec, 0, sizeof(*rec));
+}
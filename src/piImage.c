@@ -0,0 +1,269 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+/*!
+ * Project: piTest
+ * Demo source code for usage of piControl driver
+ *
+ * \file piImage.c
+ *
+ * \brief Helpers for working on copies of the process image
+ */
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "piControlIf.h"
+#include "piImage.h"
+
+/******************************************************************************/
+/*******************************  Functions  **********************************/
+/******************************************************************************/
+
+/***********************************************************************************/
+/*!
+ * @brief Parse a direct process image address
+ *
+ * Accepted forms are "@<offset>" (byte), "@<offset>.<bit>" (single bit) and
+ * "@<offset>/<8|16|32>" (byte, word or double word).
+ *
+ ************************************************************************************/
+static int parse_address(const char *spec, struct pi_var *var)
+{
+	unsigned long offset, arg;
+	char *end;
+
+	offset = strtoul(spec + 1, &end, 0);
+	if (end == spec + 1 || offset >= KB_PI_LEN)
+		return -EINVAL;
+
+	var->offset = offset;
+	var->length = 8;
+	var->bit = 0;
+
+	if (*end == '.') {
+		arg = strtoul(end + 1, &end, 10);
+		if (arg > 7)
+			return -EINVAL;
+		var->length = 1;
+		var->bit = arg;
+	} else if (*end == '/') {
+		arg = strtoul(end + 1, &end, 10);
+		if (arg != 8 && arg != 16 && arg != 32)
+			return -EINVAL;
+		var->length = arg;
+	}
+	if (*end != '\0')
+		return -EINVAL;
+	if (var->offset + piImageVarBytes(var) > KB_PI_LEN)
+		return -EINVAL;
+
+	return 0;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Resolve a variable specification
+ *
+ * A specification is either the name of a variable as configured in PiCtory or
+ * a direct address of the form "@<offset>[.<bit>|/<bits>]". The suffix ":s"
+ * marks the value as signed.
+ *
+ * @param[in]   spec	variable specification
+ * @param[out]  var	resolved variable
+ *
+ * @return 0 on success, < 0 on error
+ *
+ ************************************************************************************/
+int piImageResolve(const char *spec, struct pi_var *var)
+{
+	SPIVariable sPiVariable;
+	size_t len;
+	int rc;
+
+	memset(var, 0, sizeof(*var));
+
+	len = strlen(spec);
+	if (len > 2 && !strcmp(spec + len - 2, ":s")) {
+		var->is_signed = true;
+		len -= 2;
+	}
+	if (len == 0 || len >= sizeof(var->name)) {
+		fprintf(stderr, "Invalid variable '%s'\n", spec);
+		return -EINVAL;
+	}
+	memcpy(var->name, spec, len);
+	var->name[len] = '\0';
+
+	if (var->name[0] == '@') {
+		rc = parse_address(var->name, var);
+		if (rc < 0)
+			fprintf(stderr, "Invalid address '%s'\n", var->name);
+		return rc;
+	}
+
+	memset(&sPiVariable, 0, sizeof(sPiVariable));
+	snprintf(sPiVariable.strVarName, sizeof(sPiVariable.strVarName), "%s", var->name);
+	rc = piControlGetVariableInfo(&sPiVariable);
+	if (rc < 0) {
+		fprintf(stderr, "Failed to find variable '%s'\n", var->name);
+		return rc;
+	}
+
+	switch (sPiVariable.i16uLength) {
+	case 1:
+		/* the driver may return bit numbers beyond 7 */
+		var->offset = sPiVariable.i16uAddress + sPiVariable.i8uBit / 8;
+		var->bit = sPiVariable.i8uBit % 8;
+		break;
+	case 8:
+	case 16:
+	case 32:
+		var->offset = sPiVariable.i16uAddress;
+		break;
+	default:
+		fprintf(stderr, "Got invalid length %u for variable %s\n",
+			sPiVariable.i16uLength, var->name);
+		return -EINVAL;
+	}
+	var->length = sPiVariable.i16uLength;
+
+	return 0;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Number of bytes occupied by a variable in the process image
+ *
+ ************************************************************************************/
+uint32_t piImageVarBytes(const struct pi_var *var)
+{
+	return var->length == 1 ? 1 : var->length / 8;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Look up or resolve a variable of a table
+ *
+ * Specifications referring to an already resolved variable share its entry,
+ * so that the driver is asked only once per variable.
+ *
+ * @param[in]   table	variable table
+ * @param[in]   spec	variable specification, see piImageResolve()
+ *
+ * @return index of the variable in the table or < 0 on error
+ *
+ ************************************************************************************/
+int piVarTableAdd(struct pi_var_table *table, const char *spec)
+{
+	struct pi_var var;
+	unsigned int i;
+	int rc;
+
+	for (i = 0; i < table->count; i++) {
+		size_t len = strlen(table->vars[i].name);
+
+		if (strncmp(spec, table->vars[i].name, len))
+			continue;
+		if ((spec[len] == '\0' && !table->vars[i].is_signed) ||
+		    (!strcmp(spec + len, ":s") && table->vars[i].is_signed))
+			return i;
+	}
+
+	rc = piImageResolve(spec, &var);
+	if (rc < 0)
+		return rc;
+
+	if (table->count == table->size) {
+		unsigned int size = table->size ? table->size * 2 : 16;
+		struct pi_var *vars = realloc(table->vars, size * sizeof(*vars));
+
+		if (!vars) {
+			fprintf(stderr, "Not enough memory\n");
+			return -ENOMEM;
+		}
+		table->vars = vars;
+		table->size = size;
+	}
+	table->vars[table->count] = var;
+
+	return table->count++;
+}
+
+void piVarTableFree(struct pi_var_table *table)
+{
+	free(table->vars);
+	table->vars = NULL;
+	table->count = 0;
+	table->size = 0;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Initialize an empty span
+ *
+ ************************************************************************************/
+void piSpanInit(struct pi_span *span)
+{
+	span->offset = 0;
+	span->length = 0;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Grow a span to include a region
+ *
+ * Used to coalesce the accesses to several variables into one read or write.
+ *
+ ************************************************************************************/
+void piSpanAdd(struct pi_span *span, uint32_t offset, uint32_t length)
+{
+	uint32_t end;
+
+	if (span->length == 0) {
+		span->offset = offset;
+		span->length = length;
+		return;
+	}
+
+	end = span->offset + span->length;
+	if (offset + length > end)
+		end = offset + length;
+	if (offset < span->offset)
+		span->offset = offset;
+	span->length = end - span->offset;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Monotonic timestamp in nanoseconds
+ *
+ ************************************************************************************/
+uint64_t piImageTimestamp(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Wall clock timestamp in nanoseconds since the epoch
+ *
+ ************************************************************************************/
+uint64_t piImageWallclock(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
@@ -0,0 +1,840 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+/*!
+ * Project: piTest
+ * Demo source code for usage of piControl driver
+ *
+ * \file piLogic.c
+ *
+ * \brief Minimal soft logic executor on the process image
+ *
+ * Every rule assigns an expression over input variables to an output
+ * variable. The rules are compiled into a flat array of stack machine
+ * instructions, which is executed once per cycle between one read of all
+ * used variables and one batch of writes of the outputs. Only the bytes and
+ * bits of the outputs are written, so data of other processes sharing the
+ * process image is not overwritten.
+ */
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "piControlIf.h"
+#include "piCycle.h"
+#include "piLogic.h"
+
+/******************************************************************************/
+/*********************************  Types  ************************************/
+/******************************************************************************/
+
+#define LOGIC_STACK_SIZE	32
+
+enum logic_op {
+	OP_CONST,	/* push arg sign extended */
+	OP_CONSTU,	/* push arg zero extended */
+	OP_LOAD,	/* push variable at image position arg */
+	OP_STORE,	/* pop value into variable at image position arg */
+	OP_NOT,
+	OP_INV,
+	OP_NEG,
+	OP_ABS,
+	OP_MUL,
+	OP_DIV,
+	OP_MOD,
+	OP_ADD,
+	OP_SUB,
+	OP_SHL,
+	OP_SHR,
+	OP_LT,
+	OP_LE,
+	OP_GT,
+	OP_GE,
+	OP_EQ,
+	OP_NE,
+	OP_AND,
+	OP_XOR,
+	OP_OR,
+	OP_LAND,
+	OP_LOR,
+	OP_MIN,
+	OP_MAX,
+};
+
+struct logic_insn {
+	uint8_t op;
+	uint8_t length;		/* OP_LOAD/OP_STORE: variable length in bits */
+	uint8_t bit;
+	uint8_t is_signed;
+	uint32_t arg;		/* constant, variable index while parsing, image position */
+};
+
+/* a bit output sharing its byte with data not written by the rules */
+struct logic_bit {
+	uint16_t address;	/* offset in the process image */
+	uint8_t bit;
+};
+
+struct pi_logic {
+	struct logic_insn *code;
+	unsigned int ncode;
+	unsigned int code_size;
+	unsigned int nrules;
+	struct pi_var_table vars;
+	struct pi_span in;		/* all variables, read once per cycle */
+	struct pi_io *writes;		/* runs of whole output bytes */
+	unsigned int nwrites;
+	struct logic_bit *bits;		/* bit outputs written with KB_SET_VALUE */
+	unsigned int nbits;
+	uint8_t *image;
+};
+
+struct logic_parser {
+	struct pi_logic *logic;
+	const char *p;
+	const char *rule;
+	unsigned int line;
+	int depth;
+	int max_depth;
+};
+
+/* binary operators, longer tokens first */
+static const struct {
+	const char *token;
+	uint8_t op;
+	uint8_t prec;
+} binary_ops[] = {
+	{ "||", OP_LOR, 1 },
+	{ "&&", OP_LAND, 2 },
+	{ "==", OP_EQ, 6 },
+	{ "!=", OP_NE, 6 },
+	{ "<=", OP_LE, 7 },
+	{ ">=", OP_GE, 7 },
+	{ "<<", OP_SHL, 8 },
+	{ ">>", OP_SHR, 8 },
+	{ "|", OP_OR, 3 },
+	{ "^", OP_XOR, 4 },
+	{ "&", OP_AND, 5 },
+	{ "<", OP_LT, 7 },
+	{ ">", OP_GT, 7 },
+	{ "+", OP_ADD, 9 },
+	{ "-", OP_SUB, 9 },
+	{ "*", OP_MUL, 10 },
+	{ "/", OP_DIV, 10 },
+	{ "%", OP_MOD, 10 },
+};
+
+/******************************************************************************/
+/*******************************  Functions  **********************************/
+/******************************************************************************/
+
+struct pi_logic *piLogicCreate(void)
+{
+	return calloc(1, sizeof(struct pi_logic));
+}
+
+void piLogicFree(struct pi_logic *logic)
+{
+	if (!logic)
+		return;
+	free(logic->code);
+	piVarTableFree(&logic->vars);
+	free(logic->writes);
+	free(logic->bits);
+	free(logic->image);
+	free(logic);
+}
+
+static int parse_error(struct logic_parser *ps, const char *msg)
+{
+	fprintf(stderr, "rule %u: %s at '%s'\n", ps->line, msg, ps->p);
+	return -EINVAL;
+}
+
+static int emit(struct logic_parser *ps, uint8_t op, uint32_t arg)
+{
+	struct pi_logic *logic = ps->logic;
+	struct logic_insn *insn;
+
+	if (logic->ncode == logic->code_size) {
+		unsigned int size = logic->code_size ? logic->code_size * 2 : 64;
+		struct logic_insn *code = realloc(logic->code, size * sizeof(*code));
+
+		if (!code) {
+			fprintf(stderr, "Not enough memory\n");
+			return -ENOMEM;
+		}
+		logic->code = code;
+		logic->code_size = size;
+	}
+
+	insn = &logic->code[logic->ncode++];
+	memset(insn, 0, sizeof(*insn));
+	insn->op = op;
+	insn->arg = arg;
+
+	switch (op) {
+	case OP_CONST:
+	case OP_CONSTU:
+	case OP_LOAD:
+		ps->depth++;
+		break;
+	case OP_NOT:
+	case OP_INV:
+	case OP_NEG:
+	case OP_ABS:
+		break;
+	default:
+		ps->depth--;
+		break;
+	}
+	if (ps->depth > ps->max_depth)
+		ps->max_depth = ps->depth;
+
+	return 0;
+}
+
+static void skip_space(struct logic_parser *ps)
+{
+	while (isspace((unsigned char)*ps->p))
+		ps->p++;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Parse a variable specification
+ *
+ * Names consist of letters, digits and '_', direct addresses start with '@'.
+ * Both may carry the suffix ":s" for signed values.
+ *
+ * @return index of the variable or < 0 on error
+ *
+ ************************************************************************************/
+static int parse_var(struct logic_parser *ps)
+{
+	char spec[64];
+	const char *start = ps->p;
+	size_t len;
+
+	if (*ps->p == '@') {
+		ps->p++;
+		while (isxdigit((unsigned char)*ps->p) || *ps->p == 'x' ||
+		       *ps->p == '.' || *ps->p == '/')
+			ps->p++;
+	} else {
+		while (isalnum((unsigned char)*ps->p) || *ps->p == '_')
+			ps->p++;
+	}
+	if (ps->p[0] == ':' && ps->p[1] == 's')
+		ps->p += 2;
+
+	len = ps->p - start;
+	if (len == 0)
+		return parse_error(ps, "variable expected");
+	if (len >= sizeof(spec))
+		return parse_error(ps, "variable name too long");
+	memcpy(spec, start, len);
+	spec[len] = '\0';
+
+	return piVarTableAdd(&ps->logic->vars, spec);
+}
+
+static int parse_expr(struct logic_parser *ps, int min_prec);
+
+static int parse_call(struct logic_parser *ps, uint8_t op, int nargs)
+{
+	int rc;
+	int i;
+
+	skip_space(ps);
+	if (*ps->p != '(')
+		return parse_error(ps, "'(' expected");
+	ps->p++;
+
+	for (i = 0; i < nargs; i++) {
+		if (i > 0) {
+			skip_space(ps);
+			if (*ps->p != ',')
+				return parse_error(ps, "',' expected");
+			ps->p++;
+		}
+		rc = parse_expr(ps, 1);
+		if (rc < 0)
+			return rc;
+	}
+
+	skip_space(ps);
+	if (*ps->p != ')')
+		return parse_error(ps, "')' expected");
+	ps->p++;
+
+	return emit(ps, op, 0);
+}
+
+static int parse_unary(struct logic_parser *ps)
+{
+	long long value;
+	char *end;
+	int rc;
+
+	skip_space(ps);
+
+	switch (*ps->p) {
+	case '!':
+		ps->p++;
+		rc = parse_unary(ps);
+		return rc < 0 ? rc : emit(ps, OP_NOT, 0);
+	case '~':
+		ps->p++;
+		rc = parse_unary(ps);
+		return rc < 0 ? rc : emit(ps, OP_INV, 0);
+	case '-':
+		ps->p++;
+		rc = parse_unary(ps);
+		return rc < 0 ? rc : emit(ps, OP_NEG, 0);
+	case '+':
+		ps->p++;
+		return parse_unary(ps);
+	case '(':
+		ps->p++;
+		rc = parse_expr(ps, 1);
+		if (rc < 0)
+			return rc;
+		skip_space(ps);
+		if (*ps->p != ')')
+			return parse_error(ps, "')' expected");
+		ps->p++;
+		return 0;
+	}
+
+	if (isdigit((unsigned char)*ps->p)) {
+		errno = 0;
+		value = strtoll(ps->p, &end, 0);
+		if (errno || value > UINT32_MAX)
+			return parse_error(ps, "constant out of range");
+		ps->p = end;
+		return emit(ps, value > INT32_MAX ? OP_CONSTU : OP_CONST, (uint32_t)value);
+	}
+
+	if (!strncmp(ps->p, "min", 3) && !isalnum((unsigned char)ps->p[3]) && ps->p[3] != '_') {
+		ps->p += 3;
+		return parse_call(ps, OP_MIN, 2);
+	}
+	if (!strncmp(ps->p, "max", 3) && !isalnum((unsigned char)ps->p[3]) && ps->p[3] != '_') {
+		ps->p += 3;
+		return parse_call(ps, OP_MAX, 2);
+	}
+	if (!strncmp(ps->p, "abs", 3) && !isalnum((unsigned char)ps->p[3]) && ps->p[3] != '_') {
+		ps->p += 3;
+		return parse_call(ps, OP_ABS, 1);
+	}
+
+	rc = parse_var(ps);
+	if (rc < 0)
+		return rc;
+	return emit(ps, OP_LOAD, rc);
+}
+
+/* precedence climbing over the table of binary operators */
+static int parse_expr(struct logic_parser *ps, int min_prec)
+{
+	unsigned int i;
+	int rc;
+
+	rc = parse_unary(ps);
+	if (rc < 0)
+		return rc;
+
+	for (;;) {
+		skip_space(ps);
+		for (i = 0; i < sizeof(binary_ops) / sizeof(binary_ops[0]); i++) {
+			if (!strncmp(ps->p, binary_ops[i].token, strlen(binary_ops[i].token)))
+				break;
+		}
+		if (i == sizeof(binary_ops) / sizeof(binary_ops[0]) ||
+		    binary_ops[i].prec < min_prec)
+			return 0;
+
+		ps->p += strlen(binary_ops[i].token);
+		rc = parse_expr(ps, binary_ops[i].prec + 1);
+		if (rc < 0)
+			return rc;
+		rc = emit(ps, binary_ops[i].op, 0);
+		if (rc < 0)
+			return rc;
+	}
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Add a rule to the program
+ *
+ * A rule has the form "<output> = <expression>". Expressions use the operators
+ * of C with their precedence (except assignments and '?:') on 64 bit signed
+ * integers, and the functions min(a, b), max(a, b) and abs(a). Operands are
+ * variables and integer constants.
+ *
+ * @param[in]   logic	program
+ * @param[in]   rule	text of the rule
+ * @param[in]   line	line number used in messages
+ *
+ * @return 0 on success, < 0 on error
+ *
+ ************************************************************************************/
+int piLogicAddRule(struct pi_logic *logic, const char *rule, unsigned int line)
+{
+	unsigned int ncode = logic->ncode;
+	unsigned int nvars = logic->vars.count;
+	struct logic_parser ps;
+	int dest;
+	int rc;
+
+	memset(&ps, 0, sizeof(ps));
+	ps.logic = logic;
+	ps.rule = rule;
+	ps.p = rule;
+	ps.line = line;
+
+	skip_space(&ps);
+	rc = dest = parse_var(&ps);
+	if (rc < 0)
+		goto err;
+
+	skip_space(&ps);
+	if (ps.p[0] != '=' || ps.p[1] == '=') {
+		rc = parse_error(&ps, "'=' expected");
+		goto err;
+	}
+	ps.p++;
+
+	rc = parse_expr(&ps, 1);
+	if (rc < 0)
+		goto err;
+
+	skip_space(&ps);
+	if (*ps.p != '\0') {
+		rc = parse_error(&ps, "unexpected input");
+		goto err;
+	}
+	if (ps.max_depth > LOGIC_STACK_SIZE) {
+		rc = parse_error(&ps, "expression too complex");
+		goto err;
+	}
+
+	rc = emit(&ps, OP_STORE, dest);
+	if (rc < 0)
+		goto err;
+	logic->nrules++;
+
+	return 0;
+
+err:
+	/* drop the partially compiled rule */
+	logic->ncode = ncode;
+	logic->vars.count = nvars;
+	return rc;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Load the rules of a program from a file
+ *
+ * Every line holds one rule. Empty lines and text after '#' are ignored.
+ *
+ ************************************************************************************/
+int piLogicLoad(struct pi_logic *logic, const char *path)
+{
+	char *line = NULL;
+	size_t line_size = 0;
+	unsigned int lineno = 0;
+	FILE *fp;
+	int rc = 0;
+
+	fp = fopen(path, "r");
+	if (!fp) {
+		rc = -errno;
+		fprintf(stderr, "Failed to open rule file '%s': %s\n", path, strerror(-rc));
+		return rc;
+	}
+
+	while (getline(&line, &line_size, fp) >= 0) {
+		char *p;
+
+		lineno++;
+		p = strchr(line, '#');
+		if (p)
+			*p = '\0';
+		p = line + strlen(line);
+		while (p > line && isspace((unsigned char)p[-1]))
+			*--p = '\0';
+		for (p = line; isspace((unsigned char)*p); p++)
+			;
+		if (*p == '\0')
+			continue;
+
+		rc = piLogicAddRule(logic, p, lineno);
+		if (rc < 0)
+			break;
+	}
+
+	free(line);
+	fclose(fp);
+
+	return rc;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Split the outputs into writes
+ *
+ * Bytes completely covered by outputs are combined into runs, which are
+ * written as a batch. Bit outputs in bytes holding other data are set one by
+ * one with KB_SET_VALUE, so the other bits are not overwritten with the
+ * value read at the start of the cycle.
+ *
+ * @param[in]   owned	bits of each byte of the read region covered by outputs
+ *
+ ************************************************************************************/
+static int plan_writes(struct pi_logic *logic, const uint8_t *owned)
+{
+	uint32_t i, start, nwrites = 0, nbits = 0;
+	uint8_t bit;
+
+	for (i = 0; i < logic->in.length; i++) {
+		if (owned[i] == 0xff && (i == 0 || owned[i - 1] != 0xff))
+			nwrites++;
+		else if (owned[i] != 0xff)
+			nbits += __builtin_popcount(owned[i]);
+	}
+
+	free(logic->writes);
+	free(logic->bits);
+	logic->writes = calloc(nwrites ? nwrites : 1, sizeof(*logic->writes));
+	logic->bits = calloc(nbits ? nbits : 1, sizeof(*logic->bits));
+	logic->nwrites = 0;
+	logic->nbits = 0;
+	if (!logic->writes || !logic->bits) {
+		fprintf(stderr, "Not enough memory\n");
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < logic->in.length; i++) {
+		if (owned[i] == 0xff) {
+			for (start = i; i + 1 < logic->in.length && owned[i + 1] == 0xff; i++)
+				;
+			logic->writes[logic->nwrites].offset = logic->in.offset + start;
+			logic->writes[logic->nwrites].length = i + 1 - start;
+			logic->writes[logic->nwrites].data = logic->image + start;
+			logic->writes[logic->nwrites].write = true;
+			logic->nwrites++;
+			continue;
+		}
+
+		for (bit = 0; bit < 8; bit++) {
+			if (!(owned[i] & (1 << bit)))
+				continue;
+			logic->bits[logic->nbits].address = logic->in.offset + i;
+			logic->bits[logic->nbits].bit = bit;
+			logic->nbits++;
+		}
+	}
+
+	return 0;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Compile the program
+ *
+ * Calculates the region for the read of each cycle, turns the variable
+ * references of the instructions into positions in the buffer and splits
+ * the outputs into the writes of each cycle, see plan_writes().
+ *
+ ************************************************************************************/
+int piLogicCompile(struct pi_logic *logic)
+{
+	struct logic_insn *insn;
+	const struct pi_var *var;
+	uint8_t *owned;
+	unsigned int i;
+	int rc;
+
+	if (logic->nrules == 0) {
+		fprintf(stderr, "No rules defined\n");
+		return -EINVAL;
+	}
+
+	piSpanInit(&logic->in);
+	for (i = 0; i < logic->vars.count; i++) {
+		var = &logic->vars.vars[i];
+		piSpanAdd(&logic->in, var->offset, piImageVarBytes(var));
+	}
+
+	free(logic->image);
+	logic->image = calloc(1, logic->in.length);
+	owned = calloc(1, logic->in.length);
+	if (!logic->image || !owned) {
+		fprintf(stderr, "Not enough memory\n");
+		free(owned);
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < logic->ncode; i++) {
+		insn = &logic->code[i];
+		if (insn->op != OP_LOAD && insn->op != OP_STORE)
+			continue;
+
+		var = &logic->vars.vars[insn->arg];
+		insn->length = var->length;
+		insn->bit = var->bit;
+		insn->is_signed = var->is_signed;
+		insn->arg = var->offset - logic->in.offset;
+		if (insn->op != OP_STORE)
+			continue;
+		if (var->length == 1)
+			owned[insn->arg] |= 1 << var->bit;
+		else
+			memset(owned + insn->arg, 0xff, piImageVarBytes(var));
+	}
+
+	rc = plan_writes(logic, owned);
+	free(owned);
+
+	return rc;
+}
+
+static void store(uint8_t *p, const struct logic_insn *insn, int64_t value)
+{
+	switch (insn->length) {
+	case 1:
+		if (value)
+			p[0] |= 1 << insn->bit;
+		else
+			p[0] &= ~(1 << insn->bit);
+		break;
+	case 32:
+		p[3] = value >> 24;
+		p[2] = value >> 16;
+		/* fall through */
+	case 16:
+		p[1] = value >> 8;
+		/* fall through */
+	default:
+		p[0] = value;
+		break;
+	}
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Execute the instructions on the buffer
+ *
+ * Arithmetic is done on unsigned values where C leaves overflow undefined.
+ *
+ ************************************************************************************/
+static void execute(struct pi_logic *logic)
+{
+	const struct logic_insn *insn = logic->code;
+	const struct logic_insn *end = insn + logic->ncode;
+	uint8_t *image = logic->image;
+	int64_t stack[LOGIC_STACK_SIZE];
+	int64_t *sp = stack;
+	int64_t a, b;
+
+	for (; insn < end; insn++) {
+		switch (insn->op) {
+		case OP_CONST:
+			*sp++ = (int32_t)insn->arg;
+			continue;
+		case OP_CONSTU:
+			*sp++ = insn->arg;
+			continue;
+		case OP_LOAD:
+			*sp++ = piImageExtract(image + insn->arg, insn->length,
+					       insn->bit, insn->is_signed);
+			continue;
+		case OP_STORE:
+			store(image + insn->arg, insn, *--sp);
+			continue;
+		case OP_NOT:
+			sp[-1] = !sp[-1];
+			continue;
+		case OP_INV:
+			sp[-1] = ~sp[-1];
+			continue;
+		case OP_NEG:
+			sp[-1] = -(uint64_t)sp[-1];
+			continue;
+		case OP_ABS:
+			if (sp[-1] < 0)
+				sp[-1] = -(uint64_t)sp[-1];
+			continue;
+		}
+
+		b = *--sp;
+		a = sp[-1];
+		switch (insn->op) {
+		case OP_MUL:
+			a = (uint64_t)a * (uint64_t)b;
+			break;
+		case OP_DIV:
+			a = b == 0 ? 0 : b == -1 ? (int64_t)-(uint64_t)a : a / b;
+			break;
+		case OP_MOD:
+			a = b == 0 || b == -1 ? 0 : a % b;
+			break;
+		case OP_ADD:
+			a = (uint64_t)a + (uint64_t)b;
+			break;
+		case OP_SUB:
+			a = (uint64_t)a - (uint64_t)b;
+			break;
+		case OP_SHL:
+			a = (uint64_t)a << (b & 63);
+			break;
+		case OP_SHR:
+			a >>= b & 63;
+			break;
+		case OP_LT:
+			a = a < b;
+			break;
+		case OP_LE:
+			a = a <= b;
+			break;
+		case OP_GT:
+			a = a > b;
+			break;
+		case OP_GE:
+			a = a >= b;
+			break;
+		case OP_EQ:
+			a = a == b;
+			break;
+		case OP_NE:
+			a = a != b;
+			break;
+		case OP_AND:
+			a &= b;
+			break;
+		case OP_XOR:
+			a ^= b;
+			break;
+		case OP_OR:
+			a |= b;
+			break;
+		case OP_LAND:
+			a = a && b;
+			break;
+		case OP_LOR:
+			a = a || b;
+			break;
+		case OP_MIN:
+			a = a < b ? a : b;
+			break;
+		case OP_MAX:
+			a = a > b ? a : b;
+			break;
+		}
+		sp[-1] = a;
+	}
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Run one cycle of the program
+ *
+ * Reads all variables, executes the rules and writes the outputs back, the
+ * runs of whole bytes as one batch and the remaining bits one by one.
+ *
+ * @return 0 on success, < 0 on error
+ *
+ ************************************************************************************/
+int piLogicCycle(struct pi_logic *logic)
+{
+	const struct logic_bit *bit;
+	SPIValue value;
+	unsigned int i;
+	int rc;
+
+	rc = piControlRead(logic->in.offset, logic->in.length, logic->image);
+	if (rc < 0)
+		return rc;
+
+	execute(logic);
+
+	if (logic->nwrites) {
+		rc = piControlTransfer(logic->writes, logic->nwrites);
+		if (rc < 0)
+			return rc;
+	}
+
+	for (i = 0; i < logic->nbits; i++) {
+		bit = &logic->bits[i];
+		value.i16uAddress = bit->address;
+		value.i8uBit = bit->bit;
+		value.i8uValue = (logic->image[bit->address - logic->in.offset] >> bit->bit) & 1;
+		rc = piControlSetBitValue(&value);
+		if (rc < 0)
+			return rc;
+	}
+
+	return 0;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Execute a logic program cyclically
+ *
+ * @param[in]   path		file with the rules
+ * @param[in]   period_us	cycle time in microseconds
+ * @param[in]   cyclic		false to execute the rules only once
+ *
+ * @return 0 on success, < 0 on error
+ *
+ ************************************************************************************/
+int piLogicRun(const char *path, uint32_t period_us, bool cyclic)
+{
+	struct pi_logic *logic;
+	struct pi_cycle cycle;
+	int rc;
+
+	logic = piLogicCreate();
+	if (!logic) {
+		fprintf(stderr, "Not enough memory\n");
+		return -ENOMEM;
+	}
+
+	rc = piLogicLoad(logic, path);
+	if (rc < 0)
+		goto out;
+	rc = piLogicCompile(logic);
+	if (rc < 0)
+		goto out;
+
+	if (cyclic) {
+		rc = piCycleStart(&cycle, period_us);
+		if (rc < 0)
+			goto out;
+	}
+
+	do {
+		rc = piLogicCycle(logic);
+		if (rc < 0 && !cyclic)
+			goto out;
+	} while (cyclic && piCycleWait(&cycle));
+
+	if (cyclic)
+		piCycleFinish(&cycle);
+	rc = 0;
+out:
+	piLogicFree(logic);
+	return rc;
+}
@@ -0,0 +1,461 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+/*!
+ * Project: piTest
+ * Demo source code for usage of piControl driver
+ *
+ * \file piModule.c
+ *
+ * \brief Decoding of modules by their module type
+ *
+ * The layouts of the input and output blocks of the RevPi module types are
+ * described by tables. Together with the offsets of the device list they
+ * are compiled into a schema, see piSchema.c, so every module is decoded
+ * into named fields from a single read without looking up variables.
+ * Modules without a layout are decoded as bytes.
+ */
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "piControlIf.h"
+#include "piCycle.h"
+#include "piFormat.h"
+#include "piModule.h"
+#include "piTest.h"
+
+/******************************************************************************/
+/*********************************  Types  ************************************/
+/******************************************************************************/
+
+/*
+ * The layouts follow the default configuration of PiCtory. Fields beyond
+ * the block lengths of the device list are left out.
+ */
+
+/* DIO, DI and DO */
+static const struct pi_module_field dio_inputs[] = {
+	{ "I_%u", PI_SCHEMA_BOOL, 0, 0, 0, 16, 1 },
+	{ "InputStatus", PI_SCHEMA_U16, 2, 0, 0, 1, 0 },
+	{ "OutputStatus", PI_SCHEMA_U16, 4, 0, 0, 1, 0 },
+	{ "Counter_%u", PI_SCHEMA_S32, 6, 0, 0, 16, 4 },
+};
+
+static const struct pi_module_field dio_outputs[] = {
+	{ "O_%u", PI_SCHEMA_BOOL, 0, 0, 0, 16, 1 },
+	{ "PWM_%u", PI_SCHEMA_U8, 2, 0, 0, 16, 1 },
+};
+
+static const struct pi_module_field aio_inputs[] = {
+	{ "InputValue_%u", PI_SCHEMA_S16, 0, 0, 0, 4, 2 },
+	{ "InputStatus_%u", PI_SCHEMA_U8, 8, 0, 0, 4, 1 },
+	{ "RTDValue_%u", PI_SCHEMA_S16, 12, 0, 0, 2, 2 },
+	{ "RTDStatus_%u", PI_SCHEMA_U8, 16, 0, 0, 2, 1 },
+	{ "OutputStatus_%u", PI_SCHEMA_U8, 18, 0, 0, 2, 1 },
+};
+
+static const struct pi_module_field aio_outputs[] = {
+	{ "OutputValue_%u", PI_SCHEMA_S16, 0, 0, 0, 2, 2 },
+};
+
+/* base modules: Core, Connect, Flat */
+static const struct pi_module_field core_inputs[] = {
+	{ "RevPiStatus", PI_SCHEMA_U8, 0, 0, 0, 1, 0 },
+	{ "RevPiIOCycle", PI_SCHEMA_U8, 1, 0, 0, 1, 0 },
+	{ "RS485ErrorCnt", PI_SCHEMA_U16, 2, 0, 0, 1, 0 },
+	{ "Core_Temperature", PI_SCHEMA_U8, 4, 0, 0, 1, 0 },
+	{ "Core_Frequency", PI_SCHEMA_U8, 5, 0, 0, 1, 0 },
+};
+
+static const struct pi_module_field core_outputs[] = {
+	{ "RevPiLED", PI_SCHEMA_U8, 0, 0, 0, 1, 0 },
+	{ "RS485ErrorLimit1", PI_SCHEMA_U16, 1, 0, 0, 1, 0 },
+	{ "RS485ErrorLimit2", PI_SCHEMA_U16, 3, 0, 0, 1, 0 },
+};
+
+static const struct pi_module_field connect_outputs[] = {
+	{ "RevPiLED", PI_SCHEMA_U16, 0, 0, 0, 1, 0 },
+	{ "RS485ErrorLimit1", PI_SCHEMA_U16, 2, 0, 0, 1, 0 },
+	{ "RS485ErrorLimit2", PI_SCHEMA_U16, 4, 0, 0, 1, 0 },
+};
+
+static const struct pi_module_field compact_inputs[] = {
+	{ "RevPiStatus", PI_SCHEMA_U8, 0, 0, 0, 1, 0 },
+	{ "RevPiIOCycle", PI_SCHEMA_U8, 1, 0, 0, 1, 0 },
+	{ "Core_Temperature", PI_SCHEMA_U8, 2, 0, 0, 1, 0 },
+	{ "Core_Frequency", PI_SCHEMA_U8, 3, 0, 0, 1, 0 },
+	{ "DIn_%u", PI_SCHEMA_BOOL, 4, 0, 0, 8, 1 },
+	{ "DIn_Status", PI_SCHEMA_U8, 5, 0, 0, 1, 0 },
+	{ "DOut_Status", PI_SCHEMA_U8, 6, 0, 0, 1, 0 },
+	{ "AIn_%u", PI_SCHEMA_S16, 7, 0, 0, 8, 2 },
+};
+
+static const struct pi_module_field compact_outputs[] = {
+	{ "RevPiLED", PI_SCHEMA_U8, 0, 0, 0, 1, 0 },
+	{ "DOut_%u", PI_SCHEMA_BOOL, 1, 0, 0, 8, 1 },
+	{ "AOut_%u", PI_SCHEMA_U16, 2, 0, 0, 2, 2 },
+};
+
+static const struct pi_module_field ro_inputs[] = {
+	{ "RelayCycleWarning_%u", PI_SCHEMA_BOOL, 0, 0, 0, REVPI_RO_NUM_RELAYS, 1 },
+};
+
+static const struct pi_module_field ro_outputs[] = {
+	{ "RelayOutput_%u", PI_SCHEMA_BOOL, 0, 0, 0, REVPI_RO_NUM_RELAYS, 1 },
+};
+
+#define FIELDS(f) f, sizeof(f) / sizeof(f[0])
+
+static const struct pi_module_layout module_layouts[] = {
+	{ KUNBUS_FW_DESCR_TYP_PI_DIO_14, FIELDS(dio_inputs), FIELDS(dio_outputs) },
+	{ KUNBUS_FW_DESCR_TYP_PI_DI_16, FIELDS(dio_inputs), FIELDS(dio_outputs) },
+	{ KUNBUS_FW_DESCR_TYP_PI_DO_16, FIELDS(dio_inputs), FIELDS(dio_outputs) },
+	{ KUNBUS_FW_DESCR_TYP_PI_AIO, FIELDS(aio_inputs), FIELDS(aio_outputs) },
+	{ KUNBUS_FW_DESCR_TYP_PI_RO, FIELDS(ro_inputs), FIELDS(ro_outputs) },
+	{ KUNBUS_FW_DESCR_TYP_PI_CORE, FIELDS(core_inputs), FIELDS(core_outputs) },
+	{ KUNBUS_FW_DESCR_TYP_PI_CONNECT, FIELDS(core_inputs), FIELDS(connect_outputs) },
+	{ KUNBUS_FW_DESCR_TYP_PI_CONNECT_4, FIELDS(core_inputs), FIELDS(connect_outputs) },
+	{ KUNBUS_FW_DESCR_TYP_PI_CONNECT_5, FIELDS(core_inputs), FIELDS(connect_outputs) },
+	{ KUNBUS_FW_DESCR_TYP_PI_FLAT, FIELDS(core_inputs), FIELDS(connect_outputs) },
+	{ KUNBUS_FW_DESCR_TYP_PI_COMPACT, FIELDS(compact_inputs), FIELDS(compact_outputs) },
+};
+
+/******************************************************************************/
+/*******************************  Functions  **********************************/
+/******************************************************************************/
+
+/***********************************************************************************/
+/*!
+ * @brief Get the layout of a module type
+ *
+ * @param[in]   type	module type of the device list
+ *
+ * @return the layout or NULL if there is none
+ *
+ ************************************************************************************/
+const struct pi_module_layout *piModuleLayout(uint16_t type)
+{
+	unsigned int i;
+
+	type &= PICONTROL_NOT_CONNECTED_MASK;
+	for (i = 0; i < sizeof(module_layouts) / sizeof(module_layouts[0]); i++) {
+		if (module_layouts[i].type == type)
+			return &module_layouts[i];
+	}
+
+	return NULL;
+}
+
+static uint8_t field_width(const struct pi_module_field *field)
+{
+	switch (field->type) {
+	case PI_SCHEMA_BOOL:
+		return 1;
+	case PI_SCHEMA_BITS:
+		return field->width;
+	case PI_SCHEMA_U8:
+	case PI_SCHEMA_S8:
+		return 8;
+	case PI_SCHEMA_U16:
+	case PI_SCHEMA_S16:
+		return 16;
+	default:
+		return 32;
+	}
+}
+
+/* add a channel of a field, named <address>.<name> */
+static int add_field(struct pi_schema *schema, const SDeviceInfo *dev,
+		     const struct pi_module_field *field, unsigned int channel,
+		     uint32_t block, uint32_t block_length, uint32_t base)
+{
+	char name[PI_SCHEMA_NAME_LEN + 16], suffix[PI_SCHEMA_NAME_LEN];
+	uint32_t offset = field->offset, bit = field->bit;
+	uint8_t width = field_width(field);
+
+	if (field->type == PI_SCHEMA_BOOL)
+		bit += channel * field->stride;
+	else
+		offset += channel * field->stride;
+	offset += bit / 8;
+	bit %= 8;
+	if (offset + (bit + width + 7) / 8 > block_length)
+		return 0;
+
+	snprintf(suffix, sizeof(suffix), field->name, channel + 1);
+	snprintf(name, sizeof(name), "%u.%s", dev->i8uAddress, suffix);
+	name[PI_SCHEMA_NAME_LEN - 1] = '\0';
+
+	return piSchemaAdd(schema, name, field->type, block + offset - base, bit, width);
+}
+
+/* add the fields of an input or output block, bytes if there is no layout */
+static int add_block(struct pi_schema *schema, const SDeviceInfo *dev,
+		     const struct pi_module_field *fields, unsigned int nfields,
+		     const char *bytes, uint32_t block, uint32_t block_length, uint32_t base)
+{
+	struct pi_module_field byte = { bytes, PI_SCHEMA_U8, 0, 0, 0, 1, 1 };
+	unsigned int i, channel;
+	int rc = 0;
+
+	if (!fields) {
+		byte.count = block_length;
+		fields = &byte;
+		nfields = 1;
+	}
+
+	for (i = 0; i < nfields && rc >= 0; i++) {
+		for (channel = 0; channel < fields[i].count && rc >= 0; channel++)
+			rc = add_field(schema, dev, &fields[i], channel, block, block_length, base);
+	}
+
+	return rc;
+}
+
+static const SDeviceInfo *find_device(const SDeviceInfo *devs, int ndevs, int addr)
+{
+	int i;
+
+	for (i = 0; i < ndevs; i++) {
+		if (devs[i].i8uAddress == addr)
+			return &devs[i];
+	}
+
+	return NULL;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Compile the layouts of modules of the device list
+ *
+ * The region of every module covers its input and output block. The
+ * fields of all modules are added to one schema named <address>.<field>,
+ * decoding a buffer that holds the span of all modules.
+ *
+ * @param[out]  mods	modules, to be freed with piModulesFree()
+ * @param[in]   addrs	addresses of the modules
+ * @param[in]   naddrs	number of addresses, 0 for all modules with a block
+ *
+ * @return 0 on success, < 0 on error
+ *
+ ************************************************************************************/
+int piModulesInit(struct pi_modules *mods, const int *addrs, unsigned int naddrs)
+{
+	const struct pi_module_layout *layout;
+	const SDeviceInfo *devs, *dev;
+	struct pi_module *mod;
+	struct pi_span span;
+	unsigned int i, n;
+	int ndevs, rc = 0;
+
+	memset(mods, 0, sizeof(*mods));
+
+	ndevs = piControlGetDeviceList(&devs);
+	if (ndevs < 0)
+		return ndevs;
+
+	n = naddrs ? naddrs : (unsigned int)ndevs;
+	mods->modules = calloc(n ? n : 1, sizeof(*mods->modules));
+	if (!mods->modules) {
+		fprintf(stderr, "Not enough memory\n");
+		return -ENOMEM;
+	}
+
+	piSpanInit(&mods->span);
+	for (i = 0; i < n; i++) {
+		if (naddrs) {
+			dev = find_device(devs, ndevs, addrs[i]);
+			if (!dev) {
+				fprintf(stderr, "No module with address %d\n", addrs[i]);
+				rc = -ENODEV;
+				goto err;
+			}
+		} else {
+			dev = &devs[i];
+		}
+		if (!dev->i16uInputLength && !dev->i16uOutputLength)
+			continue;
+
+		piSpanInit(&span);
+		if (dev->i16uInputLength)
+			piSpanAdd(&span, dev->i16uInputOffset, dev->i16uInputLength);
+		if (dev->i16uOutputLength)
+			piSpanAdd(&span, dev->i16uOutputOffset, dev->i16uOutputLength);
+		piSpanAdd(&mods->span, span.offset, span.length);
+
+		mod = &mods->modules[mods->count++];
+		mod->dev = dev;
+		mod->offset = span.offset;
+		mod->length = span.length;
+	}
+	if (mods->count == 0) {
+		fprintf(stderr, "No modules with inputs or outputs\n");
+		rc = -ENODEV;
+		goto err;
+	}
+
+	for (i = 0; i < mods->count && rc >= 0; i++) {
+		mod = &mods->modules[i];
+		dev = mod->dev;
+		layout = piModuleLayout(dev->i16uModuleType);
+
+		mod->first = mods->schema.count;
+		if (dev->i16uInputLength)
+			rc = add_block(&mods->schema, dev, layout ? layout->inputs : NULL,
+				       layout ? layout->ninputs : 0, "In_%u",
+				       dev->i16uInputOffset, dev->i16uInputLength, mods->span.offset);
+		if (rc >= 0 && dev->i16uOutputLength)
+			rc = add_block(&mods->schema, dev, layout ? layout->outputs : NULL,
+				       layout ? layout->noutputs : 0, "Out_%u",
+				       dev->i16uOutputOffset, dev->i16uOutputLength, mods->span.offset);
+		mod->count = mods->schema.count - mod->first;
+	}
+	if (rc < 0) {
+		fprintf(stderr, "Failed to compile module layouts: %s\n", strerror(-rc));
+		goto err;
+	}
+
+	return 0;
+
+err:
+	piModulesFree(mods);
+	return rc;
+}
+
+void piModulesFree(struct pi_modules *mods)
+{
+	piSchemaFree(&mods->schema);
+	free(mods->modules);
+	memset(mods, 0, sizeof(*mods));
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Read the regions of modules
+ *
+ * @param[in]   mods	modules
+ * @param[out]  image	buffer for mods->span and PI_SCHEMA_PADDING bytes
+ *
+ * @return 0 on success, < 0 on error
+ *
+ ************************************************************************************/
+int piModulesRead(const struct pi_modules *mods, uint8_t *image)
+{
+	const struct pi_module *mod;
+	unsigned int i;
+	int rc;
+
+	for (i = 0; i < mods->count; i++) {
+		mod = &mods->modules[i];
+		rc = piControlRead(mod->offset, mod->length,
+				   image + (mod->offset - mods->span.offset));
+		if (rc < 0)
+			return rc;
+	}
+
+	return 0;
+}
+
+/* print the fields of one module, as text */
+static void print_module(struct pi_format *fmt, const struct pi_modules *mods,
+			 const struct pi_module *mod, const struct pi_schema_value *values)
+{
+	struct pi_schema view = {
+		.fields = mods->schema.fields + mod->first,
+		.count = mod->count,
+	};
+	uint16_t type = mod->dev->i16uModuleType;
+
+	if (!mod->dev->i8uActive)
+		type &= PICONTROL_NOT_CONNECTED_MASK;
+	piFormatPrintf(fmt, "Address: %d module type: %d (0x%x) %s\n", mod->dev->i8uAddress,
+		       mod->dev->i16uModuleType, mod->dev->i16uModuleType, getModuleName(type));
+	piSchemaPrint(&view, fmt, 0, values + mod->first);
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Print modules decoded by their module type
+ *
+ * Every module is read with one read per period.
+ *
+ * @param[in]   args	parameters of the output
+ *
+ * @return 0 on success, < 0 on error
+ *
+ ************************************************************************************/
+int piModuleRun(const struct pi_module_args *args)
+{
+	struct pi_schema_value *values = NULL;
+	struct pi_format *fmt = NULL;
+	struct pi_modules mods;
+	struct pi_cycle cycle;
+	uint8_t *image = NULL;
+	int64_t wall_offset;
+	bool first = true;
+	unsigned int i;
+	int rc;
+
+	rc = piFormatTextual(args->type);
+	if (rc < 0)
+		return rc;
+
+	rc = piModulesInit(&mods, args->addrs, args->naddrs);
+	if (rc < 0)
+		return rc;
+
+	image = calloc(1, mods.span.length + PI_SCHEMA_PADDING);
+	values = malloc(mods.schema.count * sizeof(*values));
+	fmt = malloc(sizeof(*fmt));
+	if (!image || !values || !fmt) {
+		fprintf(stderr, "Not enough memory\n");
+		rc = -ENOMEM;
+		goto out;
+	}
+
+	piFormatInit(fmt, args->type, STDOUT_FILENO, NULL, 0);
+	piSchemaPrintHeader(&mods.schema, fmt);
+	wall_offset = piImageWallclock() - piImageTimestamp();
+	rc = piCycleStart(&cycle, args->period_us);
+	if (rc < 0)
+		goto out;
+
+	do {
+		rc = piModulesRead(&mods, image);
+		if (rc < 0)
+			break;
+		piSchemaDecode(&mods.schema, image, values);
+
+		if (args->type == PI_FORMAT_TEXT) {
+			for (i = 0; i < mods.count; i++) {
+				if (!first || i)
+					piFormatPrintf(fmt, "\n");
+				print_module(fmt, &mods, &mods.modules[i], values);
+			}
+		} else {
+			piSchemaPrint(&mods.schema, fmt, piImageTimestamp() + wall_offset, values);
+		}
+		rc = piFormatFlush(fmt);
+		first = false;
+	} while (rc == 0 && !args->once && piCycleWait(&cycle));
+
+	piCycleFinish(&cycle);
+	if (piFormatFinish(fmt) < 0 && rc == 0)
+		rc = fmt->error;
+
+out:
+	free(fmt);
+	free(values);
+	free(image);
+	piModulesFree(&mods);
+	return rc;
+}
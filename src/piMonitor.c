@@ -0,0 +1,484 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+/*!
+ * Project: piTest
+ * Demo source code for usage of piControl driver
+ *
+ * \file piMonitor.c
+ *
+ * \brief Threshold and edge alarm engine
+ *
+ * A rule set is compiled once into a flat table which is evaluated against
+ * one coalesced read of all variables used by the rules. Events are only
+ * reported on transitions.
+ */
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "piControlIf.h"
+#include "piCycle.h"
+#include "piMonitor.h"
+
+/******************************************************************************/
+/*********************************  Types  ************************************/
+/******************************************************************************/
+
+/* One entry of the evaluation table, hot fields only */
+struct monitor_rule {
+	uint16_t offset;
+	uint8_t length;
+	uint8_t bit;
+	uint8_t kind;
+	uint8_t is_signed;
+	uint8_t active;		/* state of a level rule, last level of an edge rule */
+	uint8_t primed;		/* a previous sample is available */
+	int64_t set;		/* threshold which activates the rule */
+	int64_t clear;		/* threshold which deactivates the rule */
+	int64_t last;
+	uint64_t last_ts;
+	uint32_t var;		/* index into the variable table */
+	uint32_t line;
+};
+
+struct pi_monitor {
+	struct monitor_rule *rules;
+	unsigned int nrules;
+	unsigned int rules_size;
+	struct pi_var_table vars;
+	struct pi_span span;
+	uint8_t *image;
+};
+
+static const char *kind_names[] = {
+	[PI_MONITOR_RISING] = "rising",
+	[PI_MONITOR_FALLING] = "falling",
+	[PI_MONITOR_EDGE] = "edge",
+	[PI_MONITOR_ABOVE] = "above",
+	[PI_MONITOR_BELOW] = "below",
+	[PI_MONITOR_RATE] = "rate",
+};
+
+/******************************************************************************/
+/*******************************  Functions  **********************************/
+/******************************************************************************/
+
+struct pi_monitor *piMonitorCreate(void)
+{
+	return calloc(1, sizeof(struct pi_monitor));
+}
+
+void piMonitorFree(struct pi_monitor *mon)
+{
+	if (!mon)
+		return;
+	free(mon->rules);
+	piVarTableFree(&mon->vars);
+	free(mon->image);
+	free(mon);
+}
+
+const char *piMonitorKindName(enum pi_monitor_kind kind)
+{
+	return kind_names[kind];
+}
+
+static int parse_int(const char *tok, int64_t *value)
+{
+	char *end;
+
+	if (!tok)
+		return -EINVAL;
+	*value = strtoll(tok, &end, 0);
+	if (end == tok || *end != '\0')
+		return -EINVAL;
+	return 0;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Add a rule to the rule set
+ *
+ * Syntax of a rule:
+ *   edge <var> rising|falling|both
+ *   above <var> <threshold> [<hysteresis>]
+ *   below <var> <threshold> [<hysteresis>]
+ *   rate <var> <change per second> [<hysteresis>]
+ *
+ * @param[in]   mon	rule set
+ * @param[in]   rule	text of the rule
+ * @param[in]   line	line number used in messages and events
+ *
+ * @return 0 on success, < 0 on error
+ *
+ ************************************************************************************/
+int piMonitorAddRule(struct pi_monitor *mon, const char *rule, unsigned int line)
+{
+	struct monitor_rule r;
+	char buf[256];
+	char *tok[5];
+	char *save = NULL;
+	int64_t threshold, hysteresis = 0;
+	int ntok = 0;
+	int idx;
+
+	snprintf(buf, sizeof(buf), "%s", rule);
+	for (tok[ntok] = strtok_r(buf, " \t\r\n", &save); tok[ntok] && ntok < 4;
+	     tok[ntok] = strtok_r(NULL, " \t\r\n", &save))
+		ntok++;
+	if (ntok < 3 || tok[ntok]) {
+		fprintf(stderr, "rule %u: wrong number of arguments\n", line);
+		return -EINVAL;
+	}
+
+	memset(&r, 0, sizeof(r));
+	r.line = line;
+
+	if (!strcmp(tok[0], "edge")) {
+		if (ntok != 3)
+			goto invalid;
+		if (!strcmp(tok[2], "rising"))
+			r.kind = PI_MONITOR_RISING;
+		else if (!strcmp(tok[2], "falling"))
+			r.kind = PI_MONITOR_FALLING;
+		else if (!strcmp(tok[2], "both"))
+			r.kind = PI_MONITOR_EDGE;
+		else
+			goto invalid;
+	} else {
+		if (!strcmp(tok[0], "above"))
+			r.kind = PI_MONITOR_ABOVE;
+		else if (!strcmp(tok[0], "below"))
+			r.kind = PI_MONITOR_BELOW;
+		else if (!strcmp(tok[0], "rate"))
+			r.kind = PI_MONITOR_RATE;
+		else
+			goto invalid;
+
+		if (parse_int(tok[2], &threshold) < 0)
+			goto invalid;
+		if (ntok == 4 && (parse_int(tok[3], &hysteresis) < 0 || hysteresis < 0))
+			goto invalid;
+		if (r.kind == PI_MONITOR_RATE && threshold < 0)
+			threshold = -threshold;
+
+		r.set = threshold;
+		r.clear = r.kind == PI_MONITOR_BELOW ? threshold + hysteresis :
+						       threshold - hysteresis;
+	}
+
+	idx = piVarTableAdd(&mon->vars, tok[1]);
+	if (idx < 0)
+		return idx;
+	r.var = idx;
+	r.offset = mon->vars.vars[idx].offset;
+	r.length = mon->vars.vars[idx].length;
+	r.bit = mon->vars.vars[idx].bit;
+	r.is_signed = mon->vars.vars[idx].is_signed;
+
+	if (mon->nrules == mon->rules_size) {
+		unsigned int size = mon->rules_size ? mon->rules_size * 2 : 64;
+		struct monitor_rule *rules = realloc(mon->rules, size * sizeof(*rules));
+
+		if (!rules)
+			return -ENOMEM;
+		mon->rules = rules;
+		mon->rules_size = size;
+	}
+	mon->rules[mon->nrules++] = r;
+
+	return 0;
+
+invalid:
+	fprintf(stderr, "rule %u: invalid rule '%s'\n", line, rule);
+	return -EINVAL;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Load a rule set from a file
+ *
+ * Every line holds one rule. Empty lines and text after '#' are ignored.
+ *
+ ************************************************************************************/
+int piMonitorLoad(struct pi_monitor *mon, const char *path)
+{
+	char *line = NULL;
+	size_t line_size = 0;
+	unsigned int lineno = 0;
+	FILE *fp;
+	int rc = 0;
+
+	fp = fopen(path, "r");
+	if (!fp) {
+		rc = -errno;
+		fprintf(stderr, "Failed to open rule file '%s': %s\n", path, strerror(-rc));
+		return rc;
+	}
+
+	while (getline(&line, &line_size, fp) >= 0) {
+		char *p;
+
+		lineno++;
+		p = strchr(line, '#');
+		if (p)
+			*p = '\0';
+		for (p = line; *p == ' ' || *p == '\t'; p++)
+			;
+		if (*p == '\0' || *p == '\n' || *p == '\r')
+			continue;
+
+		rc = piMonitorAddRule(mon, p, lineno);
+		if (rc < 0)
+			break;
+	}
+
+	free(line);
+	fclose(fp);
+
+	return rc;
+}
+
+static int compare_rules(const void *a, const void *b)
+{
+	const struct monitor_rule *ra = a, *rb = b;
+
+	if (ra->offset != rb->offset)
+		return ra->offset < rb->offset ? -1 : 1;
+	return ra->line < rb->line ? -1 : ra->line > rb->line;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Compile the rule set into its evaluation table
+ *
+ * The rules are sorted by their position in the process image and the region
+ * covering all variables is calculated, so that one read per cycle suffices.
+ *
+ ************************************************************************************/
+int piMonitorCompile(struct pi_monitor *mon)
+{
+	unsigned int i;
+
+	if (mon->nrules == 0) {
+		fprintf(stderr, "No rules defined\n");
+		return -EINVAL;
+	}
+
+	qsort(mon->rules, mon->nrules, sizeof(*mon->rules), compare_rules);
+
+	piSpanInit(&mon->span);
+	for (i = 0; i < mon->vars.count; i++)
+		piSpanAdd(&mon->span, mon->vars.vars[i].offset,
+			  piImageVarBytes(&mon->vars.vars[i]));
+
+	free(mon->image);
+	mon->image = calloc(1, mon->span.length);
+	if (!mon->image) {
+		fprintf(stderr, "Not enough memory\n");
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
+const struct pi_span *piMonitorSpan(const struct pi_monitor *mon)
+{
+	return &mon->span;
+}
+
+static void emit(struct pi_monitor *mon, const struct monitor_rule *r, uint64_t timestamp,
+		 int64_t value, bool active, piMonitorEventFn fn, void *ctx)
+{
+	struct pi_monitor_event ev;
+
+	ev.timestamp = timestamp;
+	ev.rule = r->line;
+	ev.kind = r->kind;
+	ev.var = &mon->vars.vars[r->var];
+	ev.value = value;
+	ev.active = active;
+	fn(ctx, &ev);
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Evaluate all rules against one sample of the process image
+ *
+ * @param[in]   mon		compiled rule set
+ * @param[in]   image		buffer holding at least the span of the rule set
+ * @param[in]   base		offset of the buffer in the process image
+ * @param[in]   timestamp	monotonic time of the sample in ns
+ * @param[in]   fn		called for every transition
+ * @param[in]   ctx		passed to fn
+ *
+ * @return number of events
+ *
+ ************************************************************************************/
+int piMonitorEvaluate(struct pi_monitor *mon, const uint8_t *image, uint32_t base,
+		      uint64_t timestamp, piMonitorEventFn fn, void *ctx)
+{
+	struct monitor_rule *r = mon->rules;
+	struct monitor_rule *end = r + mon->nrules;
+	int events = 0;
+	int64_t value;
+	int64_t rate;
+	bool level;
+
+	for (; r < end; r++) {
+		value = piImageExtract(image + (r->offset - base), r->length,
+				       r->bit, r->is_signed);
+
+		switch (r->kind) {
+		case PI_MONITOR_RISING:
+		case PI_MONITOR_FALLING:
+		case PI_MONITOR_EDGE:
+			level = value != 0;
+			if (r->primed && level != r->active &&
+			    (r->kind == PI_MONITOR_EDGE ||
+			     level == (r->kind == PI_MONITOR_RISING))) {
+				emit(mon, r, timestamp, value, level, fn, ctx);
+				events++;
+			}
+			r->active = level;
+			r->primed = 1;
+			break;
+
+		case PI_MONITOR_ABOVE:
+			if (!r->active && value > r->set) {
+				r->active = 1;
+				emit(mon, r, timestamp, value, true, fn, ctx);
+				events++;
+			} else if (r->active && value < r->clear) {
+				r->active = 0;
+				emit(mon, r, timestamp, value, false, fn, ctx);
+				events++;
+			}
+			break;
+
+		case PI_MONITOR_BELOW:
+			if (!r->active && value < r->set) {
+				r->active = 1;
+				emit(mon, r, timestamp, value, true, fn, ctx);
+				events++;
+			} else if (r->active && value > r->clear) {
+				r->active = 0;
+				emit(mon, r, timestamp, value, false, fn, ctx);
+				events++;
+			}
+			break;
+
+		case PI_MONITOR_RATE:
+			if (r->primed && timestamp > r->last_ts) {
+				rate = (value - r->last) * 1000000000LL /
+				       (int64_t)(timestamp - r->last_ts);
+				if (rate < 0)
+					rate = -rate;
+				if (!r->active && rate > r->set) {
+					r->active = 1;
+					emit(mon, r, timestamp, rate, true, fn, ctx);
+					events++;
+				} else if (r->active && rate < r->clear) {
+					r->active = 0;
+					emit(mon, r, timestamp, rate, false, fn, ctx);
+					events++;
+				}
+			}
+			r->last = value;
+			r->last_ts = timestamp;
+			r->primed = 1;
+			break;
+		}
+	}
+
+	return events;
+}
+
+/* ctx holds the difference between wall clock and monotonic clock */
+static void print_event(void *ctx, const struct pi_monitor_event *ev)
+{
+	uint64_t wall = ev->timestamp + *(int64_t *)ctx;
+	const char *state;
+
+	if (ev->kind == PI_MONITOR_RISING || ev->kind == PI_MONITOR_FALLING ||
+	    ev->kind == PI_MONITOR_EDGE)
+		state = ev->active ? "RISE" : "FALL";
+	else
+		state = ev->active ? "ON" : "OFF";
+
+	printf("%" PRIu64 ".%06" PRIu64 " %u %s %s %s %" PRId64 "\n",
+	       wall / 1000000000, (wall % 1000000000) / 1000, ev->rule,
+	       kind_names[ev->kind], ev->var->name, state, ev->value);
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Monitor the process image with a rule set
+ *
+ * Reads the variables used by the rules with a single read per cycle and
+ * prints a timestamped line for every transition of a rule.
+ *
+ * @param[in]   path		file with the rules
+ * @param[in]   period_us	cycle time in microseconds
+ * @param[in]   cyclic		false to evaluate the rules only once
+ *
+ * @return 0 on success, < 0 on error
+ *
+ ************************************************************************************/
+int piMonitorRun(const char *path, uint32_t period_us, bool cyclic)
+{
+	struct pi_monitor *mon;
+	struct pi_cycle cycle;
+	int64_t wall_offset;
+	uint64_t ts;
+	int rc;
+
+	mon = piMonitorCreate();
+	if (!mon) {
+		fprintf(stderr, "Not enough memory\n");
+		return -ENOMEM;
+	}
+
+	rc = piMonitorLoad(mon, path);
+	if (rc < 0)
+		goto out;
+	rc = piMonitorCompile(mon);
+	if (rc < 0)
+		goto out;
+
+	wall_offset = piImageWallclock() - piImageTimestamp();
+	if (cyclic) {
+		rc = piCycleStart(&cycle, period_us);
+		if (rc < 0)
+			goto out;
+	}
+
+	do {
+		rc = piControlRead(mon->span.offset, mon->span.length, mon->image);
+		if (rc < 0) {
+			if (!cyclic)
+				goto out;
+		} else {
+			ts = piImageTimestamp();
+			if (piMonitorEvaluate(mon, mon->image, mon->span.offset, ts,
+					      print_event, &wall_offset))
+				fflush(stdout);
+		}
+	} while (cyclic && piCycleWait(&cycle));
+
+	if (cyclic)
+		piCycleFinish(&cycle);
+	rc = 0;
+out:
+	piMonitorFree(mon);
+	return rc;
+}
@@ -0,0 +1,290 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+/*!
+ * Project: piTest
+ * Demo source code for usage of piControl driver
+ *
+ * \file piRelay.c
+ *
+ * \brief Relay counters of all RO modules
+ *
+ * The switching cycles of the relays of all RO modules of the device list
+ * are collected in one pass. The counters are kept in a state file, so the
+ * next run computes the switching rate of every relay since the previous
+ * one, e.g. to track the wear of relays of many systems from cron.
+ */
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "piControlIf.h"
+#include "piFormat.h"
+#include "piRelay.h"
+
+/******************************************************************************/
+/*********************************  Types  ************************************/
+/******************************************************************************/
+
+#define RELAY_ADDRESSES 256
+#define NS_PER_HOUR (3600 * 1000000000ULL)
+
+/* counters of the previous run, indexed by the address */
+struct relay_state {
+	bool valid;
+	struct pi_ro_counters counters;
+};
+
+/******************************************************************************/
+/*******************************  Functions  **********************************/
+/******************************************************************************/
+
+/* lines of "<address> <timestamp> <counter>...", a missing file is no error */
+static int load_state(const char *path, struct relay_state *state)
+{
+	unsigned int address, c[REVPI_RO_NUM_RELAYS], lineno = 0;
+	char line[256], *p;
+	uint64_t timestamp;
+	FILE *fp;
+	int i;
+
+	fp = fopen(path, "r");
+	if (!fp)
+		return errno == ENOENT ? 0 : -errno;
+
+	while (fgets(line, sizeof(line), fp)) {
+		lineno++;
+		p = strchr(line, '#');
+		if (p)
+			*p = '\0';
+		if (line[strspn(line, " \t\n")] == '\0')
+			continue;
+
+		if (sscanf(line, "%u %" SCNu64 " %u %u %u %u", &address, &timestamp,
+			   &c[0], &c[1], &c[2], &c[3]) != 2 + REVPI_RO_NUM_RELAYS ||
+		    address >= RELAY_ADDRESSES) {
+			fprintf(stderr, "%s:%u: invalid entry ignored\n", path, lineno);
+			continue;
+		}
+
+		state[address].valid = true;
+		state[address].counters.address = address;
+		state[address].counters.timestamp = timestamp;
+		for (i = 0; i < REVPI_RO_NUM_RELAYS; i++)
+			state[address].counters.counter[i] = c[i];
+	}
+
+	fclose(fp);
+	return 0;
+}
+
+/* replace the state file, modules not read in this run keep their entry */
+static int save_state(const char *path, const struct relay_state *state)
+{
+	char tmp[4096];
+	unsigned int address;
+	FILE *fp;
+	int i, rc = 0;
+
+	if (snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= (int)sizeof(tmp))
+		return -ENAMETOOLONG;
+
+	fp = fopen(tmp, "w");
+	if (!fp)
+		return -errno;
+
+	fprintf(fp, "# address timestamp_ns counter_1..counter_%d\n", REVPI_RO_NUM_RELAYS);
+	for (address = 0; address < RELAY_ADDRESSES; address++) {
+		if (!state[address].valid)
+			continue;
+		fprintf(fp, "%u %" PRIu64, address, state[address].counters.timestamp);
+		for (i = 0; i < REVPI_RO_NUM_RELAYS; i++)
+			fprintf(fp, " %" PRIu32, state[address].counters.counter[i]);
+		fprintf(fp, "\n");
+	}
+
+	if (ferror(fp))
+		rc = -EIO;
+	if (fclose(fp) != 0 && rc == 0)
+		rc = -errno;
+	if (rc == 0 && rename(tmp, path) != 0)
+		rc = -errno;
+	if (rc < 0)
+		remove(tmp);
+
+	return rc;
+}
+
+static const char *const relay_columns[] = {
+	"ts_ns", "address", "relay", "counter", "delta", "cycles_per_hour",
+};
+
+static void print_header(struct pi_format *fmt)
+{
+	unsigned int i;
+
+	if (fmt->type == PI_FORMAT_TEXT) {
+		piFormatPrintf(fmt, "%7s %5s %11s %11s %15s\n", "address", "relay", "counter",
+			       "delta", "cycles_per_hour");
+		return;
+	}
+
+	for (i = 0; i < sizeof(relay_columns) / sizeof(relay_columns[0]); i++)
+		piFormatName(fmt, relay_columns[i]);
+	piFormatEnd(fmt);
+}
+
+/* print the counters of a module, prev is NULL if there is no previous run */
+static void print_module(struct pi_format *fmt, const struct pi_ro_counters *cur,
+			 const struct pi_ro_counters *prev)
+{
+	uint64_t duration = 0;
+	bool known;
+	int64_t delta;
+	double rate;
+	int i;
+
+	if (prev && cur->timestamp > prev->timestamp)
+		duration = cur->timestamp - prev->timestamp;
+
+	for (i = 0; i < REVPI_RO_NUM_RELAYS; i++) {
+		/* a counter going back means the module has been replaced */
+		known = duration && cur->counter[i] >= prev->counter[i];
+		delta = known ? (int64_t)cur->counter[i] - prev->counter[i] : 0;
+		rate = known ? delta * (double)NS_PER_HOUR / duration : 0;
+
+		if (fmt->type == PI_FORMAT_TEXT) {
+			piFormatPrintf(fmt, "%7u %5d %11" PRIu32, cur->address, i + 1,
+				       cur->counter[i]);
+			if (known)
+				piFormatPrintf(fmt, " %11" PRId64 " %15.3f\n", delta, rate);
+			else
+				piFormatPrintf(fmt, " %11s %15s\n", "-", "-");
+			continue;
+		}
+
+		piFormatKey(fmt, "ts_ns");
+		piFormatUint(fmt, cur->timestamp);
+		piFormatKey(fmt, "address");
+		piFormatUint(fmt, cur->address);
+		piFormatKey(fmt, "relay");
+		piFormatUint(fmt, i + 1);
+		piFormatKey(fmt, "counter");
+		piFormatUint(fmt, cur->counter[i]);
+		piFormatKey(fmt, "delta");
+		if (known)
+			piFormatInt(fmt, delta);
+		else
+			piFormatNull(fmt);
+		piFormatKey(fmt, "cycles_per_hour");
+		if (known)
+			piFormatDouble(fmt, "%.3f", rate);
+		else
+			piFormatNull(fmt);
+		piFormatEnd(fmt);
+	}
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Print the relay counters of all RO modules
+ *
+ * The counters of every RO module of the device list are read and printed.
+ * With a state file the differences to the counters of the previous run
+ * and the switching rates in cycles per hour are printed as well, and the
+ * state file is updated. Modules failing to respond are reported and
+ * skipped.
+ *
+ * @param[in]   args	parameters of the output
+ *
+ * @return number of RO modules read, < 0 on error
+ *
+ ************************************************************************************/
+int piRelayRun(const struct pi_relay_args *args)
+{
+	struct pi_format *fmt = NULL;
+	struct relay_state *state;
+	struct pi_ro_counters cur;
+	const SDeviceInfo *devs;
+	int ndevs, i, found = 0, read = 0, rc = 0;
+	bool had_prev;
+
+	rc = piFormatTextual(args->type);
+	if (rc < 0)
+		return rc;
+
+	state = calloc(RELAY_ADDRESSES, sizeof(*state));
+	fmt = malloc(sizeof(*fmt));
+	if (!state || !fmt) {
+		fprintf(stderr, "Not enough memory\n");
+		rc = -ENOMEM;
+		goto out;
+	}
+
+	if (args->state) {
+		rc = load_state(args->state, state);
+		if (rc < 0) {
+			fprintf(stderr, "Cannot read state file '%s': %s\n", args->state,
+				strerror(-rc));
+			goto out;
+		}
+	}
+
+	ndevs = piControlGetDeviceList(&devs);
+	if (ndevs < 0) {
+		rc = ndevs;
+		goto out;
+	}
+
+	piFormatInit(fmt, args->type, STDOUT_FILENO, NULL, 0);
+	print_header(fmt);
+	for (i = 0; i < ndevs; i++) {
+		if ((devs[i].i16uModuleType & PICONTROL_NOT_CONNECTED_MASK) !=
+		    KUNBUS_FW_DESCR_TYP_PI_RO || !devs[i].i8uActive)
+			continue;
+		found++;
+
+		if (piControlReadROCounters(devs[i].i8uAddress, &cur) < 0) {
+			fprintf(stderr, "Skipping RO module at address %d\n", devs[i].i8uAddress);
+			continue;
+		}
+		read++;
+
+		had_prev = args->state && state[cur.address].valid;
+		print_module(fmt, &cur, had_prev ? &state[cur.address].counters : NULL);
+		state[cur.address].valid = true;
+		state[cur.address].counters = cur;
+	}
+
+	if (piFormatFinish(fmt) < 0) {
+		rc = fmt->error;
+		goto out;
+	}
+
+	if (found == 0)
+		fprintf(stderr, "No RO modules found\n");
+
+	if (args->state && read) {
+		rc = save_state(args->state, state);
+		if (rc < 0) {
+			fprintf(stderr, "Cannot write state file '%s': %s\n", args->state,
+				strerror(-rc));
+			goto out;
+		}
+	}
+	rc = found && !read ? -EIO : read;
+
+out:
+	free(fmt);
+	free(state);
+	return rc;
+}
@@ -0,0 +1,206 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+/*!
+ * Project: piTest
+ * Demo source code for usage of piControl driver
+ *
+ * \file piRing.c
+ *
+ * \brief Lock-free ring of samples between two threads
+ *
+ * The producer reserves a slot, fills it in place and commits it with a
+ * timestamp, the consumer peeks at the oldest sample and releases it when
+ * done. Head and tail are only written by one side each, so no lock is
+ * needed. The producer never waits: if the ring is full the sample is
+ * dropped and counted as overflow. The consumer sleeps on a semaphore while
+ * the ring is empty.
+ */
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <errno.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "piRing.h"
+
+/******************************************************************************/
+/*********************************  Types  ************************************/
+/******************************************************************************/
+
+struct pi_ring {
+	uint32_t mask;			/* number of slots - 1 */
+	uint32_t sample_size;
+	uint8_t *samples;
+	uint64_t *timestamps;
+	sem_t filled;			/* posted once per committed sample and on close */
+	atomic_bool closed;
+	atomic_uint_fast64_t overflows;
+	/* written by the producer and the consumer, on separate cache lines */
+	_Alignas(64) atomic_uint head;
+	_Alignas(64) atomic_uint tail;
+};
+
+/******************************************************************************/
+/*******************************  Functions  **********************************/
+/******************************************************************************/
+
+/***********************************************************************************/
+/*!
+ * @brief Create a ring
+ *
+ * @param[in]   slots		number of samples the ring can hold, rounded up to
+ *				a power of two
+ * @param[in]   sample_size	size of a sample in bytes
+ *
+ * @return the ring, NULL if there is not enough memory
+ *
+ ************************************************************************************/
+struct pi_ring *piRingCreate(uint32_t slots, uint32_t sample_size)
+{
+	struct pi_ring *ring;
+	uint32_t n = 1;
+
+	while (n < slots)
+		n *= 2;
+
+	ring = aligned_alloc(64, (sizeof(*ring) + 63) & ~63UL);
+	if (!ring)
+		return NULL;
+
+	ring->mask = n - 1;
+	ring->sample_size = sample_size;
+	ring->samples = calloc(n, sample_size ? sample_size : 1);
+	ring->timestamps = calloc(n, sizeof(*ring->timestamps));
+	if (!ring->samples || !ring->timestamps || sem_init(&ring->filled, 0, 0) < 0) {
+		free(ring->samples);
+		free(ring->timestamps);
+		free(ring);
+		return NULL;
+	}
+	atomic_init(&ring->closed, false);
+	atomic_init(&ring->overflows, 0);
+	atomic_init(&ring->head, 0);
+	atomic_init(&ring->tail, 0);
+
+	return ring;
+}
+
+void piRingFree(struct pi_ring *ring)
+{
+	if (!ring)
+		return;
+
+	sem_destroy(&ring->filled);
+	free(ring->samples);
+	free(ring->timestamps);
+	free(ring);
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Reserve the next slot for the producer
+ *
+ * @return slot to fill with a sample, NULL if the ring is full, which is
+ *         counted as overflow
+ *
+ ************************************************************************************/
+uint8_t *piRingReserve(struct pi_ring *ring)
+{
+	unsigned int head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	unsigned int tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+	if (head - tail > ring->mask) {
+		atomic_fetch_add_explicit(&ring->overflows, 1, memory_order_relaxed);
+		return NULL;
+	}
+
+	return ring->samples + (size_t)(head & ring->mask) * ring->sample_size;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Pass the reserved slot to the consumer
+ *
+ * @param[in]   ring		ring
+ * @param[in]   timestamp	timestamp of the sample
+ *
+ ************************************************************************************/
+void piRingCommit(struct pi_ring *ring, uint64_t timestamp)
+{
+	unsigned int head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+	ring->timestamps[head & ring->mask] = timestamp;
+	atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+	sem_post(&ring->filled);
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Signal the consumer that no more samples follow
+ *
+ ************************************************************************************/
+void piRingClose(struct pi_ring *ring)
+{
+	atomic_store(&ring->closed, true);
+	sem_post(&ring->filled);
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Wait for the oldest sample
+ *
+ * @param[in]   ring		ring
+ * @param[out]  timestamp	timestamp of the sample
+ *
+ * @return the sample, valid until piRingRelease(), NULL if the ring was
+ *         closed and all samples were consumed
+ *
+ ************************************************************************************/
+const uint8_t *piRingPeek(struct pi_ring *ring, uint64_t *timestamp)
+{
+	unsigned int tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+	for (;;) {
+		if (atomic_load_explicit(&ring->head, memory_order_acquire) != tail) {
+			*timestamp = ring->timestamps[tail & ring->mask];
+			return ring->samples + (size_t)(tail & ring->mask) * ring->sample_size;
+		}
+		/* samples committed before closing are still consumed */
+		if (atomic_load(&ring->closed)) {
+			if (atomic_load_explicit(&ring->head, memory_order_acquire) != tail)
+				continue;
+			return NULL;
+		}
+		while (sem_wait(&ring->filled) < 0 && errno == EINTR)
+			;
+	}
+}
+
+void piRingRelease(struct pi_ring *ring)
+{
+	unsigned int tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+	atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+}
+
+/* number of committed samples not yet released by the consumer */
+uint32_t piRingPending(const struct pi_ring *ring)
+{
+	struct pi_ring *r = (struct pi_ring *)ring;
+
+	return atomic_load_explicit(&r->head, memory_order_acquire) -
+	       atomic_load_explicit(&r->tail, memory_order_relaxed);
+}
+
+uint64_t piRingOverflows(const struct pi_ring *ring)
+{
+	return atomic_load_explicit(&((struct pi_ring *)ring)->overflows,
+				    memory_order_relaxed);
+}
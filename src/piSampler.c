@@ -0,0 +1,166 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+/*!
+ * Project: piTest
+ * Demo source code for usage of piControl driver
+ *
+ * \file piSampler.c
+ *
+ * \brief Cyclic sampling with a separate output thread
+ *
+ * The sampling thread passes its samples through a ring, see piRing.c, to an
+ * output thread which formats and writes them. A slow output therefore does
+ * not delay the sampling; samples are dropped and counted if the ring is
+ * full.
+ */
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "piControlIf.h"
+#include "piCycle.h"
+#include "piImage.h"
+#include "piSampler.h"
+
+/******************************************************************************/
+/*******************************  Functions  **********************************/
+/******************************************************************************/
+
+static void *output_start(void *arg)
+{
+	struct pi_sampler *sampler = arg;
+	const uint8_t *sample;
+	uint64_t timestamp;
+
+	while ((sample = piRingPeek(sampler->ring, &timestamp)) != NULL) {
+		sampler->output(sampler->ctx, timestamp, sample);
+		piRingRelease(sampler->ring);
+		/* write in batches while samples are queued */
+		if (sampler->flush && !piRingPending(sampler->ring))
+			sampler->flush(sampler->ctx);
+	}
+
+	return NULL;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Create the ring and start the output thread
+ *
+ * Has to be called before the realtime profile is applied by piCycleStart(),
+ * so that the output thread keeps the normal priority.
+ *
+ * @param[in]   sampler		output and flush set, the rest is initialized
+ * @param[in]   slots		samples the ring holds, 0 for a ring of about
+ *				PI_SAMPLER_RING_BYTES
+ * @param[in]   sample_size	size of a sample in bytes
+ *
+ * @return 0 on success, < 0 on error
+ *
+ ************************************************************************************/
+int piSamplerStart(struct pi_sampler *sampler, uint32_t slots, uint32_t sample_size)
+{
+	int rc;
+
+	if (slots == 0) {
+		slots = PI_SAMPLER_RING_BYTES / (sample_size ? sample_size : 1);
+		if (slots < PI_SAMPLER_RING_MIN_SLOTS)
+			slots = PI_SAMPLER_RING_MIN_SLOTS;
+	}
+
+	sampler->ring = piRingCreate(slots, sample_size);
+	if (!sampler->ring) {
+		fprintf(stderr, "Not enough memory\n");
+		return -ENOMEM;
+	}
+
+	rc = pthread_create(&sampler->thread, NULL, output_start, sampler);
+	if (rc != 0) {
+		fprintf(stderr, "error creating output thread: %d (%s)\n", rc, strerror(rc));
+		piRingFree(sampler->ring);
+		sampler->ring = NULL;
+		return -rc;
+	}
+
+	return 0;
+}
+
+/* pass a copy of a sample to the output thread, dropped and counted if the ring is full */
+void piSamplerPush(struct pi_sampler *sampler, const uint8_t *sample, uint32_t length,
+		   uint64_t timestamp)
+{
+	uint8_t *slot = piRingReserve(sampler->ring);
+
+	if (slot) {
+		memcpy(slot, sample, length);
+		piRingCommit(sampler->ring, timestamp);
+	}
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Read a region every period into the ring
+ *
+ * The region is read directly into the slots of the ring. Runs until
+ * interrupted.
+ *
+ * @param[in]   sampler		started sampler, slots of at least length bytes
+ * @param[in]   offset		region of the process image
+ * @param[in]   length
+ * @param[in]   period_us	cycle time in microseconds
+ *
+ * @return 0 on success, < 0 on error
+ *
+ ************************************************************************************/
+int piSamplerRead(struct pi_sampler *sampler, uint32_t offset, uint32_t length,
+		  uint32_t period_us)
+{
+	struct pi_cycle cycle;
+	uint8_t *slot;
+	int rc;
+
+	rc = piCycleStart(&cycle, period_us);
+	if (rc < 0)
+		return rc;
+
+	do {
+		slot = piRingReserve(sampler->ring);
+		if (slot && piControlRead(offset, length, slot) >= 0)
+			piRingCommit(sampler->ring, piImageTimestamp());
+	} while (piCycleWait(&cycle));
+
+	piCycleFinish(&cycle);
+	return 0;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Stop the output thread after the queued samples
+ *
+ * Reports the dropped samples and frees the ring.
+ *
+ ************************************************************************************/
+void piSamplerStop(struct pi_sampler *sampler)
+{
+	uint64_t overflows;
+
+	if (!sampler->ring)
+		return;
+
+	piRingClose(sampler->ring);
+	pthread_join(sampler->thread, NULL);
+
+	overflows = piRingOverflows(sampler->ring);
+	if (overflows)
+		fprintf(stderr, "%" PRIu64 " samples dropped, the output was too slow\n", overflows);
+	piRingFree(sampler->ring);
+	sampler->ring = NULL;
+}
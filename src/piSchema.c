@@ -0,0 +1,499 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+/*!
+ * Project: piTest
+ * Demo source code for usage of piControl driver
+ *
+ * \file piSchema.c
+ *
+ * \brief Typed decoding of regions of the process image
+ *
+ * A schema describes a region of the process image as typed fields: signed
+ * and unsigned integers of 8, 16 and 32 bits, single bits, bitfields and
+ * floats. The fields are compiled once into a position, shift, mask and sign
+ * bit, so a read of the region is decoded in a single pass.
+ */
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <errno.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "piControlIf.h"
+#include "piCycle.h"
+#include "piFormat.h"
+#include "piImage.h"
+#include "piSchema.h"
+
+/******************************************************************************/
+/*********************************  Types  ************************************/
+/******************************************************************************/
+
+static const struct {
+	const char *name;
+	enum pi_schema_type type;
+	uint8_t width;
+} schema_types[] = {
+	{ "u8", PI_SCHEMA_U8, 8 },
+	{ "s8", PI_SCHEMA_S8, 8 },
+	{ "u16", PI_SCHEMA_U16, 16 },
+	{ "s16", PI_SCHEMA_S16, 16 },
+	{ "u32", PI_SCHEMA_U32, 32 },
+	{ "s32", PI_SCHEMA_S32, 32 },
+	{ "bool", PI_SCHEMA_BOOL, 1 },
+	{ "f32", PI_SCHEMA_F32, 32 },
+};
+
+/******************************************************************************/
+/*******************************  Functions  **********************************/
+/******************************************************************************/
+
+/***********************************************************************************/
+/*!
+ * @brief Parse the name of a field type
+ *
+ * The types are u8, s8, u16, s16, u32, s32, bool, f32 and bits<n> for an
+ * unsigned bitfield of n bits.
+ *
+ * @param[in]   name	name of the type
+ * @param[out]  type	type
+ * @param[out]  width	number of bits of the type
+ *
+ * @return 0 on success, -EINVAL for an unknown type
+ *
+ ************************************************************************************/
+int piSchemaParseType(const char *name, enum pi_schema_type *type, uint8_t *width)
+{
+	unsigned int i, n;
+	int pos = 0;
+
+	for (i = 0; i < sizeof(schema_types) / sizeof(schema_types[0]); i++) {
+		if (!strcmp(name, schema_types[i].name)) {
+			*type = schema_types[i].type;
+			*width = schema_types[i].width;
+			return 0;
+		}
+	}
+
+	if (sscanf(name, "bits%u%n", &n, &pos) == 1 && name[pos] == '\0' && n >= 1 && n <= 32) {
+		*type = PI_SCHEMA_BITS;
+		*width = n;
+		return 0;
+	}
+
+	return -EINVAL;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Add a field to a schema
+ *
+ * @param[in]   schema	schema
+ * @param[in]   name	name of the field
+ * @param[in]   type	type of the field
+ * @param[in]   offset	byte offset of the field in the region
+ * @param[in]   bit	first bit of BOOL and BITS fields, 0 otherwise
+ * @param[in]   width	number of bits of BITS fields, see piSchemaParseType()
+ *
+ * @return index of the field or < 0 on error
+ *
+ ************************************************************************************/
+int piSchemaAdd(struct pi_schema *schema, const char *name, enum pi_schema_type type,
+		uint32_t offset, uint8_t bit, uint8_t width)
+{
+	struct pi_schema_field *field;
+	uint32_t end;
+	size_t len;
+
+	len = strlen(name);
+	if (len == 0 || len >= PI_SCHEMA_NAME_LEN)
+		return -EINVAL;
+	if (width == 0 || width > 32 || bit > 7 ||
+	    (bit && type != PI_SCHEMA_BOOL && type != PI_SCHEMA_BITS))
+		return -EINVAL;
+	/* checked before adding the length, a huge offset would wrap around */
+	if (offset >= KB_PI_LEN)
+		return -ERANGE;
+	end = offset + (bit + width + 7) / 8;
+	if (end > KB_PI_LEN)
+		return -ERANGE;
+
+	if (schema->count == schema->size) {
+		unsigned int size = schema->size ? schema->size * 2 : 16;
+		struct pi_schema_field *fields = realloc(schema->fields, size * sizeof(*fields));
+
+		if (!fields)
+			return -ENOMEM;
+		schema->fields = fields;
+		schema->size = size;
+	}
+
+	field = &schema->fields[schema->count];
+	memset(field, 0, sizeof(*field));
+	memcpy(field->name, name, len);
+	field->type = type;
+	field->offset = offset;
+	field->bit = bit;
+	field->width = width;
+	field->mask = width == 32 ? UINT32_MAX : (1U << width) - 1;
+	if (type == PI_SCHEMA_S8 || type == PI_SCHEMA_S16 || type == PI_SCHEMA_S32)
+		field->sign = 1U << (width - 1);
+
+	if (end > schema->length)
+		schema->length = end;
+
+	return schema->count++;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Add a field for a resolved variable
+ *
+ * 1 bit variables become bools, the others integers of their length and
+ * signedness.
+ *
+ * @param[in]   schema	schema
+ * @param[in]   var	variable, see piImageResolve()
+ * @param[in]   base	offset of the region in the process image, at most
+ *			var->offset
+ *
+ * @return index of the field or < 0 on error
+ *
+ ************************************************************************************/
+int piSchemaAddVar(struct pi_schema *schema, const struct pi_var *var, uint32_t base)
+{
+	static const enum pi_schema_type types[2][3] = {
+		{ PI_SCHEMA_U8, PI_SCHEMA_U16, PI_SCHEMA_U32 },
+		{ PI_SCHEMA_S8, PI_SCHEMA_S16, PI_SCHEMA_S32 },
+	};
+
+	if (var->offset < base)
+		return -ERANGE;
+
+	if (var->length == 1)
+		return piSchemaAdd(schema, var->name, PI_SCHEMA_BOOL, var->offset - base, var->bit, 1);
+	return piSchemaAdd(schema, var->name, types[var->is_signed][var->length / 16],
+			   var->offset - base, 0, var->length);
+}
+
+/* add a field described by a variable of the configuration */
+static int schema_add_var(struct pi_schema *schema, const char *spec, uint32_t base)
+{
+	struct pi_var var;
+	int rc;
+
+	rc = piImageResolve(spec, &var);
+	if (rc < 0)
+		return rc;
+
+	return piSchemaAddVar(schema, &var, base);
+}
+
+static int schema_add_line(struct pi_schema *schema, const char *args, uint32_t base)
+{
+	char name[64], type_name[16], spec[64];
+	enum pi_schema_type type;
+	unsigned int offset, bit = 0;
+	uint8_t width;
+	int n;
+
+	if (sscanf(args, "var %63s", spec) == 1)
+		return schema_add_var(schema, spec, base);
+
+	n = sscanf(args, "%63s %15s %u.%u", name, type_name, &offset, &bit);
+	if (n < 3)
+		return -EINVAL;
+	if (piSchemaParseType(type_name, &type, &width) < 0)
+		return -EINVAL;
+	if ((n == 4) != (type == PI_SCHEMA_BOOL || type == PI_SCHEMA_BITS))
+		return -EINVAL;
+
+	return piSchemaAdd(schema, name, type, offset, bit, width);
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Load a schema
+ *
+ * Every line of the file describes a field, either as
+ *
+ *   <name> <type> <offset>		integers and floats
+ *   <name> <type> <offset>.<bit>	bool and bits<n>
+ *   var <variable>			variable of the configuration
+ *
+ * with offsets relative to the region. Variables are resolved with
+ * piImageResolve() and have to be located at or after base. Everything
+ * after a '#' is a comment.
+ *
+ * @param[out]  schema	schema, to be freed with piSchemaFree()
+ * @param[in]   path	path of the file
+ * @param[in]   base	offset of the region in the process image
+ *
+ * @return 0 on success, < 0 on error
+ *
+ ************************************************************************************/
+int piSchemaLoad(struct pi_schema *schema, const char *path, uint32_t base)
+{
+	char line[256], *p;
+	unsigned int lineno = 0;
+	FILE *fp;
+	int rc = 0;
+
+	memset(schema, 0, sizeof(*schema));
+
+	fp = fopen(path, "r");
+	if (!fp) {
+		rc = -errno;
+		fprintf(stderr, "Cannot open schema '%s': %s\n", path, strerror(-rc));
+		return rc;
+	}
+
+	while (rc >= 0 && fgets(line, sizeof(line), fp)) {
+		lineno++;
+		p = strchr(line, '#');
+		if (p)
+			*p = '\0';
+		p = line + strspn(line, " \t\n");
+		if (!*p)
+			continue;
+
+		rc = schema_add_line(schema, p, base);
+		if (rc < 0)
+			fprintf(stderr, "%s:%u: invalid field: %s\n", path, lineno, strerror(-rc));
+	}
+	fclose(fp);
+
+	if (rc >= 0 && schema->count == 0) {
+		fprintf(stderr, "No fields in schema '%s'\n", path);
+		rc = -EINVAL;
+	}
+	if (rc < 0) {
+		piSchemaFree(schema);
+		return rc;
+	}
+
+	return 0;
+}
+
+void piSchemaFree(struct pi_schema *schema)
+{
+	free(schema->fields);
+	memset(schema, 0, sizeof(*schema));
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Decode a read of a region
+ *
+ * Every field is loaded as 64 bit little endian word, shifted, masked and
+ * sign extended by flipping and subtracting the sign bit, which is 0 for
+ * unsigned fields. Floats are reinterpreted from the low 32 bits.
+ *
+ * @param[in]   schema	schema of the region
+ * @param[in]   region	read of the region followed by PI_SCHEMA_PADDING bytes
+ * @param[out]  values	one value per field
+ *
+ ************************************************************************************/
+void piSchemaDecode(const struct pi_schema *schema, const uint8_t *region,
+		    struct pi_schema_value *values)
+{
+	const struct pi_schema_field *field;
+	unsigned int i, b;
+	uint64_t raw;
+	uint32_t bits;
+	float f;
+
+	for (i = 0; i < schema->count; i++) {
+		field = &schema->fields[i];
+
+		for (raw = 0, b = 0; b < 8; b++)
+			raw |= (uint64_t)region[field->offset + b] << (8 * b);
+		raw = (raw >> field->bit) & field->mask;
+
+		if (field->type == PI_SCHEMA_F32) {
+			bits = raw;
+			memcpy(&f, &bits, sizeof(f));
+			values[i].f = f;
+		} else {
+			values[i].i = (int64_t)(raw ^ field->sign) - field->sign;
+		}
+	}
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Print the header of the output of piSchemaPrint()
+ *
+ * Only CSV has a header.
+ *
+ * @param[in]   schema	schema of the region
+ * @param[in]   fmt	output
+ *
+ ************************************************************************************/
+void piSchemaPrintHeader(const struct pi_schema *schema, struct pi_format *fmt)
+{
+	unsigned int i;
+
+	piFormatName(fmt, "ts_ns");
+	for (i = 0; i < schema->count; i++)
+		piFormatName(fmt, schema->fields[i].name);
+	piFormatEnd(fmt);
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Format a decoded value as text
+ *
+ * @param[in]   field	field of the value
+ * @param[in]   value	value returned by piSchemaDecode()
+ * @param[out]  buf	buffer for the text
+ * @param[in]   size	size of the buffer
+ *
+ * @return like snprintf()
+ *
+ ************************************************************************************/
+int piSchemaFormat(const struct pi_schema_field *field, const struct pi_schema_value *value,
+		   char *buf, size_t size)
+{
+	if (field->type == PI_SCHEMA_F32)
+		return snprintf(buf, size, "%.9g", value->f);
+	return snprintf(buf, size, "%" PRId64, value->i);
+}
+
+static void print_value(struct pi_format *fmt, const struct pi_schema_field *field,
+			const struct pi_schema_value *value)
+{
+	char buf[32];
+
+	if (field->type == PI_SCHEMA_F32) {
+		piFormatDouble(fmt, "%.9g", value->f);
+	} else if (field->type == PI_SCHEMA_BOOL) {
+		piFormatBool(fmt, value->i);
+	} else {
+		piSchemaFormat(field, value, buf, sizeof(buf));
+		piFormatPrintf(fmt, "%s", buf);
+	}
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Print decoded values
+ *
+ * Text is one line per field, CSV one line and NDJSON one object per call.
+ *
+ * @param[in]   schema		schema of the region
+ * @param[in]   fmt		output
+ * @param[in]   timestamp	wall clock time of the read in ns
+ * @param[in]   values		values returned by piSchemaDecode()
+ *
+ ************************************************************************************/
+void piSchemaPrint(const struct pi_schema *schema, struct pi_format *fmt, uint64_t timestamp,
+		   const struct pi_schema_value *values)
+{
+	const struct pi_schema_field *field;
+	char buf[32];
+	unsigned int i;
+
+	if (fmt->type == PI_FORMAT_TEXT) {
+		for (i = 0; i < schema->count; i++) {
+			field = &schema->fields[i];
+			piSchemaFormat(field, &values[i], buf, sizeof(buf));
+			piFormatPrintf(fmt, "%-*s %s\n", PI_SCHEMA_NAME_LEN, field->name, buf);
+		}
+		return;
+	}
+
+	piFormatKey(fmt, "ts_ns");
+	piFormatUint(fmt, timestamp);
+	for (i = 0; i < schema->count; i++) {
+		piFormatKey(fmt, schema->fields[i].name);
+		print_value(fmt, &schema->fields[i], &values[i]);
+	}
+	piFormatEnd(fmt);
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Print a region of the process image decoded by a schema
+ *
+ * The region is read with one read per period. In the text format the
+ * samples are separated by an empty line.
+ *
+ * @param[in]   args	parameters of the output
+ *
+ * @return 0 on success, < 0 on error
+ *
+ ************************************************************************************/
+int piSchemaRun(const struct pi_schema_args *args)
+{
+	struct pi_schema_value *values = NULL;
+	struct pi_format *fmt = NULL;
+	struct pi_schema schema;
+	struct pi_cycle cycle;
+	uint8_t *region = NULL;
+	int64_t wall_offset;
+	bool first = true;
+	int rc;
+
+	rc = piFormatTextual(args->type);
+	if (rc < 0)
+		return rc;
+
+	rc = piSchemaLoad(&schema, args->path, args->offset);
+	if (rc < 0)
+		return rc;
+	if (args->offset + schema.length > KB_PI_LEN) {
+		fprintf(stderr, "Schema exceeds the process image\n");
+		rc = -ERANGE;
+		goto out;
+	}
+
+	region = calloc(1, schema.length + PI_SCHEMA_PADDING);
+	values = malloc(schema.count * sizeof(*values));
+	fmt = malloc(sizeof(*fmt));
+	if (!region || !values || !fmt) {
+		fprintf(stderr, "Not enough memory\n");
+		rc = -ENOMEM;
+		goto out;
+	}
+
+	piFormatInit(fmt, args->type, STDOUT_FILENO, NULL, 0);
+	piSchemaPrintHeader(&schema, fmt);
+	wall_offset = piImageWallclock() - piImageTimestamp();
+	rc = piCycleStart(&cycle, args->period_us);
+	if (rc < 0)
+		goto out;
+
+	do {
+		rc = piControlRead(args->offset, schema.length, region);
+		if (rc < 0)
+			break;
+		rc = 0;
+		piSchemaDecode(&schema, region, values);
+		if (args->type == PI_FORMAT_TEXT && !first)
+			piFormatPrintf(fmt, "\n");
+		piSchemaPrint(&schema, fmt, piImageTimestamp() + wall_offset, values);
+		rc = piFormatFlush(fmt);
+		first = false;
+	} while (rc == 0 && !args->once && piCycleWait(&cycle));
+
+	piCycleFinish(&cycle);
+	if (piFormatFinish(fmt) < 0 && rc == 0)
+		rc = fmt->error;
+
+out:
+	free(fmt);
+	free(values);
+	free(region);
+	piSchemaFree(&schema);
+	return rc;
+}
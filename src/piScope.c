@@ -0,0 +1,221 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+/*!
+ * Project: piTest
+ * Demo source code for usage of piControl driver
+ *
+ * \file piScope.c
+ *
+ * \brief Trigger based capture of windows around events
+ *
+ * Like an oscilloscope the process image is sampled continuously, the last
+ * samples are kept in a preallocated history. When one of the trigger rules
+ * fires, the history and the following samples are passed through a ring to
+ * an output thread, which writes them in one of the formats of piFormat.
+ * Samples outside of these windows are never written.
+ */
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "piControlIf.h"
+#include "piCycle.h"
+#include "piFormat.h"
+#include "piMonitor.h"
+#include "piSampler.h"
+#include "piScope.h"
+
+/******************************************************************************/
+/*********************************  Types  ************************************/
+/******************************************************************************/
+
+struct scope_output {
+	struct pi_format *fmt;
+	uint32_t skip;			/* bytes of a sample before the written variables */
+};
+
+/******************************************************************************/
+/*******************************  Functions  **********************************/
+/******************************************************************************/
+
+static void scope_output(void *ctx, uint64_t timestamp, const uint8_t *sample)
+{
+	struct scope_output *out = ctx;
+
+	piFormatSample(out->fmt, timestamp, sample + out->skip);
+}
+
+static void scope_flush(void *ctx)
+{
+	struct scope_output *out = ctx;
+
+	piFormatFlush(out->fmt);
+}
+
+/* remember the first trigger of a sample: any edge, or a level rule becoming active */
+static void on_trigger(void *ctx, const struct pi_monitor_event *ev)
+{
+	struct pi_monitor_event *trigger = ctx;
+
+	if (trigger->var)
+		return;
+	if (ev->active || ev->kind == PI_MONITOR_FALLING || ev->kind == PI_MONITOR_EDGE)
+		*trigger = *ev;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Write windows of samples around triggers
+ *
+ * The variables and the variables of the trigger rules are read with one
+ * read per period. When a trigger fires, the up to pre preceding samples,
+ * the trigger sample and post following samples are written. Triggers
+ * within a window are ignored, afterwards the triggers are armed again.
+ * Samples of a window are not written again as history of the next one.
+ *
+ * @param[in]   args	parameters of the capture
+ *
+ * @return number of written windows, < 0 on error
+ *
+ ************************************************************************************/
+int piScopeRun(const struct pi_scope_args *args)
+{
+	struct pi_var_table table = { 0 };
+	struct pi_monitor_event trigger;
+	struct scope_output out = { 0 };
+	struct pi_sampler sampler = {
+		.output = scope_output,
+		.flush = scope_flush,
+		.ctx = &out,
+	};
+	struct pi_monitor *mon;
+	struct pi_cycle cycle;
+	struct pi_span span;
+	uint64_t *hist_ts = NULL, ts;
+	uint8_t *hist = NULL, *cur;
+	unsigned int slots = args->pre + 1, head = 0, filled = 0, remaining = 0;
+	unsigned int i, windows = 0;
+	int64_t wall_offset;
+	bool written;
+	int rc;
+
+	mon = piMonitorCreate();
+	if (!mon) {
+		fprintf(stderr, "Not enough memory\n");
+		return -ENOMEM;
+	}
+	for (i = 0, rc = 0; i < args->ntriggers && rc >= 0; i++)
+		rc = piMonitorAddRule(mon, args->triggers[i], i + 1);
+	if (rc < 0)
+		goto out;
+	rc = piMonitorCompile(mon);
+	if (rc < 0)
+		goto out;
+
+	for (i = 0; i < args->nvars && rc >= 0; i++)
+		rc = piVarTableAdd(&table, args->vars[i]);
+	if (rc < 0)
+		goto out;
+
+	span = *piMonitorSpan(mon);
+	for (i = 0; i < table.count; i++)
+		piSpanAdd(&span, table.vars[i].offset, piImageVarBytes(&table.vars[i]));
+
+	hist = malloc((size_t)slots * span.length);
+	hist_ts = malloc(slots * sizeof(*hist_ts));
+	out.fmt = malloc(sizeof(*out.fmt));
+	if (!hist || !hist_ts || !out.fmt) {
+		fprintf(stderr, "Not enough memory\n");
+		rc = -ENOMEM;
+		goto out;
+	}
+
+	rc = piFormatInit(out.fmt, args->type == PI_FORMAT_TEXT ? PI_FORMAT_CSV : args->type,
+			  STDOUT_FILENO, table.vars, table.count);
+	if (rc < 0)
+		goto out;
+	out.skip = out.fmt->offset - span.offset;
+	fflush(stdout);
+	piFormatHeader(out.fmt);
+
+	/* the ring holds a whole window, so a window is only lost if the output stalls */
+	rc = piSamplerStart(&sampler, args->pre + args->post + 1, span.length);
+	if (rc < 0) {
+		piFormatFinish(out.fmt);
+		goto out;
+	}
+
+	wall_offset = piImageWallclock() - piImageTimestamp();
+	rc = piCycleStart(&cycle, args->period_us);
+	if (rc == 0) {
+		do {
+			cur = hist + (size_t)head * span.length;
+			if (piControlRead(span.offset, span.length, cur) < 0)
+				continue;
+			ts = piImageTimestamp();
+			hist_ts[head] = ts;
+
+			trigger.var = NULL;
+			piMonitorEvaluate(mon, cur, span.offset, ts, on_trigger, &trigger);
+
+			written = remaining || trigger.var;
+			if (remaining) {
+				piSamplerPush(&sampler, cur, span.length, ts);
+				if (--remaining == 0 && args->once)
+					break;
+			} else if (trigger.var) {
+				for (i = filled; i > 0; i--) {
+					unsigned int idx = (head + slots - i) % slots;
+
+					piSamplerPush(&sampler, hist + (size_t)idx * span.length,
+						      span.length, hist_ts[idx]);
+				}
+				piSamplerPush(&sampler, cur, span.length, ts);
+				remaining = args->post;
+				windows++;
+
+				ts += wall_offset;
+				fprintf(stderr, "trigger %u at %" PRIu64 ".%06" PRIu64 ": rule %u %s %s %" PRId64 "\n",
+					windows, ts / 1000000000, (ts % 1000000000) / 1000, trigger.rule,
+					piMonitorKindName(trigger.kind), trigger.var->name, trigger.value);
+				if (remaining == 0 && args->once)
+					break;
+			}
+
+			head = (head + 1) % slots;
+			/* written samples are no history of the next trigger */
+			if (written)
+				filled = 0;
+			else if (filled < args->pre)
+				filled++;
+		} while (piCycleWait(&cycle));
+		piCycleFinish(&cycle);
+	}
+
+	piSamplerStop(&sampler);
+	if (piFormatFinish(out.fmt) < 0) {
+		fprintf(stderr, "Failed to write output: %s\n", strerror(-out.fmt->error));
+		if (rc >= 0)
+			rc = out.fmt->error;
+	}
+	if (rc >= 0)
+		rc = windows;
+
+out:
+	free(out.fmt);
+	free(hist_ts);
+	free(hist);
+	piVarTableFree(&table);
+	piMonitorFree(mon);
+	return rc;
+}
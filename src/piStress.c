@@ -0,0 +1,556 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+/*!
+ * Project: piTest
+ * Demo source code for usage of piControl driver
+ *
+ * \file piStress.c
+ *
+ * \brief Multi-threaded stress benchmarks of the piControl interface
+ */
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "piControlIf.h"
+#include "piImage.h"
+#include "piStress.h"
+
+/******************************************************************************/
+/*********************************  Types  ************************************/
+/******************************************************************************/
+
+/* latency histogram with power of two buckets in ns */
+#define LATENCY_BUCKETS		32
+
+struct stress_thread {
+	pthread_t id;
+	bool writer;
+	bool bits;
+	uint32_t offset;
+	uint32_t length;
+	const uint8_t *data;		/* content written by writers */
+	uint8_t *buf;			/* buffer of readers */
+	uint64_t ops;
+	uint64_t errors;
+	uint64_t lat_sum;
+	uint64_t lat_max;
+	uint64_t hist[LATENCY_BUCKETS];
+};
+
+/* read paths checked by the torn read test */
+enum torn_path {
+	TORN_PATH_VARIABLE,	/* one read per variable */
+	TORN_PATH_BLOCK,	/* one read covering all variables */
+	TORN_PATHS,
+};
+
+struct torn_test {
+	struct pi_var *vars;
+	unsigned int nvars;
+	struct pi_span span;
+	uint64_t writes;
+};
+
+struct torn_reader {
+	pthread_t id;
+	const struct torn_test *test;
+	uint8_t *buf;
+	uint64_t reads[TORN_PATHS];
+	uint64_t torn[TORN_PATHS];
+};
+
+/******************************************************************************/
+/******************************  Global Vars  *********************************/
+/******************************************************************************/
+
+static atomic_bool stress_go;
+static atomic_bool stress_stop;
+
+/******************************************************************************/
+/*******************************  Functions  **********************************/
+/******************************************************************************/
+
+static void record_latency(struct stress_thread *t, uint64_t ns)
+{
+	int bucket = ns ? 63 - __builtin_clzll(ns) : 0;
+
+	if (bucket >= LATENCY_BUCKETS)
+		bucket = LATENCY_BUCKETS - 1;
+	t->hist[bucket]++;
+	t->lat_sum += ns;
+	if (ns > t->lat_max)
+		t->lat_max = ns;
+	t->ops++;
+}
+
+/* upper bound of the bucket holding the 99th percentile in ns */
+static uint64_t latency_p99(const struct stress_thread *t)
+{
+	uint64_t limit = t->ops - t->ops / 100;
+	uint64_t count = 0;
+	int i;
+
+	for (i = 0; i < LATENCY_BUCKETS; i++) {
+		count += t->hist[i];
+		if (count >= limit)
+			break;
+	}
+	return 2ULL << i;
+}
+
+static void *stress_thread_start(void *arg)
+{
+	struct stress_thread *t = arg;
+	uint32_t nbits = t->length * 8;
+	uint32_t bit = 0;
+	SPIValue value;
+	uint64_t start;
+	int rc;
+
+	/* start all threads at the same time */
+	while (!atomic_load(&stress_go) && !atomic_load(&stress_stop))
+		sched_yield();
+
+	while (!atomic_load_explicit(&stress_stop, memory_order_relaxed)) {
+		start = piImageTimestamp();
+		if (t->bits) {
+			value.i16uAddress = t->offset + bit / 8;
+			value.i8uBit = bit % 8;
+			if (t->writer) {
+				value.i8uValue = (t->data[bit / 8] >> (bit % 8)) & 1;
+				rc = piControlSetBitValue(&value);
+			} else {
+				rc = piControlGetBitValue(&value);
+			}
+			if (++bit == nbits)
+				bit = 0;
+		} else if (t->writer) {
+			rc = piControlWrite(t->offset, t->length, (uint8_t *)t->data);
+		} else {
+			rc = piControlRead(t->offset, t->length, t->buf);
+		}
+
+		if (rc < 0) {
+			/* the interface already printed the reason */
+			t->errors++;
+			break;
+		}
+		record_latency(t, piImageTimestamp() - start);
+	}
+
+	return NULL;
+}
+
+static void report_thread(const struct stress_thread *t, unsigned int idx, double seconds)
+{
+	printf("    %s %2u: %10.0f ops/s  latency avg %8.2f us  p99 < %8.2f us  max %8.2f us%s\n",
+	       t->writer ? "writer" : "reader", idx, t->ops / seconds,
+	       t->ops ? t->lat_sum / 1e3 / t->ops : 0.0, latency_p99(t) / 1e3,
+	       t->lat_max / 1e3, t->errors ? "  (stopped by error)" : "");
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Run one step of the contention benchmark
+ *
+ * @return 0 on success, < 0 on error
+ *
+ ************************************************************************************/
+static int run_step(const struct pi_contention_args *args, const uint8_t *initial,
+		    unsigned int readers, unsigned int writers)
+{
+	unsigned int nthreads = readers + writers;
+	struct stress_thread *threads;
+	struct timespec duration;
+	uint64_t start = 0, ops = 0;
+	uint32_t slice;
+	double seconds;
+	unsigned int i, started;
+	int rc = 0;
+
+	threads = calloc(nthreads, sizeof(*threads));
+	if (!threads) {
+		fprintf(stderr, "Not enough memory\n");
+		return -ENOMEM;
+	}
+
+	/* disjoint slices, the last thread also takes the remainder */
+	slice = args->overlap ? args->length : args->length / nthreads;
+	for (i = 0; i < nthreads; i++) {
+		struct stress_thread *t = &threads[i];
+		uint32_t pos = args->overlap ? 0 : i * slice;
+
+		t->writer = i >= readers;
+		t->bits = args->bits;
+		t->offset = args->offset + pos;
+		t->length = args->overlap || i < nthreads - 1 ? slice : args->length - pos;
+		t->data = initial + pos;
+		t->buf = malloc(t->length);
+		if (!t->buf) {
+			fprintf(stderr, "Not enough memory\n");
+			rc = -ENOMEM;
+			goto out;
+		}
+	}
+
+	atomic_store(&stress_go, false);
+	atomic_store(&stress_stop, false);
+	for (started = 0; started < nthreads; started++) {
+		rc = pthread_create(&threads[started].id, NULL, stress_thread_start,
+				    &threads[started]);
+		if (rc != 0) {
+			fprintf(stderr, "error creating thread: %d (%s)\n", rc, strerror(rc));
+			rc = -rc;
+			break;
+		}
+	}
+
+	if (started == nthreads) {
+		start = piImageTimestamp();
+		atomic_store(&stress_go, true);
+		duration.tv_sec = args->seconds;
+		duration.tv_nsec = 0;
+		while (nanosleep(&duration, &duration) < 0 && errno == EINTR)
+			;
+	}
+	atomic_store(&stress_stop, true);
+
+	for (i = 0; i < started; i++)
+		pthread_join(threads[i].id, NULL);
+	if (started < nthreads)
+		goto out;
+
+	seconds = (piImageTimestamp() - start) / 1e9;
+	for (i = 0; i < nthreads; i++)
+		ops += threads[i].ops;
+
+	printf("%u readers, %u writers: %.0f ops/s\n", readers, writers, ops / seconds);
+	for (i = 0; i < nthreads; i++)
+		report_thread(&threads[i], threads[i].writer ? i - readers : i, seconds);
+	fflush(stdout);
+
+out:
+	for (i = 0; i < nthreads; i++)
+		free(threads[i].buf);
+	free(threads);
+	return rc;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Measure the contention of concurrent accesses to the driver
+ *
+ * Runs reader and writer threads which access a region of the process image
+ * as fast as possible through the piControl interface, sharing its handle.
+ * The thread count is doubled from step to step until the given maximum
+ * number of readers and writers is reached, so that the point where the
+ * aggregate throughput stops scaling becomes visible.
+ *
+ * Writers write the content which the region had at the start of the
+ * benchmark, or set the bits to their initial value. Values written by
+ * other processes meanwhile are overwritten, so the region should not hold
+ * outputs of a running application.
+ *
+ * @param[in]   args	parameters of the benchmark
+ *
+ * @return 0 on success, < 0 on error
+ *
+ ************************************************************************************/
+int piStressContention(const struct pi_contention_args *args)
+{
+	unsigned int max = args->readers > args->writers ? args->readers : args->writers;
+	unsigned int step, readers, writers;
+	uint8_t *initial;
+	int rc;
+
+	if (max == 0 || args->length == 0 || args->offset + args->length > KB_PI_LEN) {
+		fprintf(stderr, "Invalid region or thread count\n");
+		return -EINVAL;
+	}
+	if (!args->overlap && args->length < args->readers + args->writers) {
+		fprintf(stderr, "Region of %" PRIu32 " bytes is too small for %u threads\n",
+			args->length, args->readers + args->writers);
+		return -EINVAL;
+	}
+
+	/* open the handle before it is shared by the threads */
+	rc = piControlOpen();
+	if (rc < 0)
+		return rc;
+
+	initial = malloc(args->length);
+	if (!initial) {
+		fprintf(stderr, "Not enough memory\n");
+		return -ENOMEM;
+	}
+	rc = piControlRead(args->offset, args->length, initial);
+	if (rc < 0)
+		goto out;
+
+	printf("%s of %" PRIu32 " bytes at offset %" PRIu32 " with %s, %u s per step\n",
+	       args->overlap ? "Overlapping accesses" : "Disjoint accesses",
+	       args->length, args->offset,
+	       args->bits ? "bit ioctls" : "read/write", args->seconds);
+
+	for (step = 1; ; step *= 2) {
+		if (step > max)
+			step = max;
+		readers = step < args->readers ? step : args->readers;
+		writers = step < args->writers ? step : args->writers;
+
+		rc = run_step(args, initial, readers, writers);
+		if (rc < 0 || step == max)
+			break;
+	}
+
+out:
+	free(initial);
+	return rc < 0 ? rc : 0;
+}
+
+/*
+ * Self-checking patterns: the upper half of a variable always holds the
+ * complement of its lower half, a read mixing two writes breaks the relation.
+ */
+static void torn_pattern(uint8_t *p, uint16_t length, uint32_t counter)
+{
+	if (length == 16) {
+		p[0] = counter;
+		p[1] = ~counter;
+	} else {
+		p[0] = counter;
+		p[1] = counter >> 8;
+		p[2] = ~counter;
+		p[3] = ~counter >> 8;
+	}
+}
+
+static bool torn_check(const uint8_t *p, uint16_t length)
+{
+	if (length == 16)
+		return (p[0] ^ p[1]) != 0xff;
+	return (p[0] ^ p[2]) != 0xff || (p[1] ^ p[3]) != 0xff;
+}
+
+static void *torn_writer_start(void *arg)
+{
+	struct torn_test *test = arg;
+	uint32_t counter = 0;
+	uint8_t data[4];
+	unsigned int i;
+
+	while (!atomic_load(&stress_go) && !atomic_load(&stress_stop))
+		sched_yield();
+
+	while (!atomic_load_explicit(&stress_stop, memory_order_relaxed)) {
+		counter++;
+		for (i = 0; i < test->nvars; i++) {
+			torn_pattern(data, test->vars[i].length, counter);
+			if (piControlWrite(test->vars[i].offset, test->vars[i].length / 8, data) < 0)
+				return NULL;
+			test->writes++;
+		}
+	}
+
+	return NULL;
+}
+
+static void *torn_reader_start(void *arg)
+{
+	struct torn_reader *r = arg;
+	const struct torn_test *test = r->test;
+	const struct pi_var *var;
+	uint64_t iteration = 0;
+	unsigned int i;
+
+	while (!atomic_load(&stress_go) && !atomic_load(&stress_stop))
+		sched_yield();
+
+	while (!atomic_load_explicit(&stress_stop, memory_order_relaxed)) {
+		if (iteration++ & 1) {
+			if (piControlRead(test->span.offset, test->span.length, r->buf) < 0)
+				break;
+			r->reads[TORN_PATH_BLOCK]++;
+			for (i = 0; i < test->nvars; i++) {
+				var = &test->vars[i];
+				if (torn_check(r->buf + (var->offset - test->span.offset), var->length))
+					r->torn[TORN_PATH_BLOCK]++;
+			}
+		} else {
+			for (i = 0; i < test->nvars; i++) {
+				var = &test->vars[i];
+				if (piControlRead(var->offset, var->length / 8, r->buf) < 0)
+					return NULL;
+				r->reads[TORN_PATH_VARIABLE]++;
+				if (torn_check(r->buf, var->length))
+					r->torn[TORN_PATH_VARIABLE]++;
+			}
+		}
+	}
+
+	return NULL;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Check that multi-byte variables are read atomically
+ *
+ * A writer thread continuously writes self-checking patterns to the given 16
+ * and 32 bit variables, one write per variable. Reader threads read them
+ * alternately with one read per variable and with one read covering all
+ * variables, and count the values which do not match the pattern. Any
+ * inconsistent value means that a read observed a partially applied write.
+ *
+ * The variables are overwritten, so they must not be used by a running
+ * application or be connected to outputs.
+ *
+ * @param[in]   args	parameters of the test
+ *
+ * @return 0 if no torn value was seen, 1 if there were torn values, < 0 on error
+ *
+ ************************************************************************************/
+int piStressTorn(const struct pi_torn_args *args)
+{
+	static const char *path_names[] = {
+		[TORN_PATH_VARIABLE] = "variable",
+		[TORN_PATH_BLOCK] = "block",
+	};
+	struct torn_reader *readers;
+	struct torn_test test;
+	struct timespec duration;
+	pthread_t writer;
+	uint64_t reads, torn, values, start = 0;
+	double seconds;
+	unsigned int i, started = 0;
+	bool writer_started = false;
+	int path;
+	int rc;
+
+	if (args->readers == 0 || args->nvars == 0) {
+		fprintf(stderr, "At least one reader and one variable are needed\n");
+		return -EINVAL;
+	}
+
+	memset(&test, 0, sizeof(test));
+	test.vars = calloc(args->nvars, sizeof(*test.vars));
+	readers = calloc(args->readers, sizeof(*readers));
+	if (!test.vars || !readers) {
+		fprintf(stderr, "Not enough memory\n");
+		rc = -ENOMEM;
+		goto out;
+	}
+
+	piSpanInit(&test.span);
+	for (i = 0; i < args->nvars; i++) {
+		rc = piImageResolve(args->vars[i], &test.vars[i]);
+		if (rc < 0)
+			goto out;
+		if (test.vars[i].length != 16 && test.vars[i].length != 32) {
+			fprintf(stderr, "Variable '%s' is not a 16 or 32 bit variable\n",
+				args->vars[i]);
+			rc = -EINVAL;
+			goto out;
+		}
+		piSpanAdd(&test.span, test.vars[i].offset, test.vars[i].length / 8);
+	}
+	test.nvars = args->nvars;
+
+	rc = piControlOpen();
+	if (rc < 0)
+		goto out;
+
+	for (i = 0; i < args->readers; i++) {
+		readers[i].test = &test;
+		readers[i].buf = malloc(test.span.length);
+		if (!readers[i].buf) {
+			fprintf(stderr, "Not enough memory\n");
+			rc = -ENOMEM;
+			goto out;
+		}
+	}
+
+	/* readers must not see the initial content before the first write */
+	for (i = 0; i < test.nvars; i++) {
+		uint8_t data[4];
+
+		torn_pattern(data, test.vars[i].length, 0);
+		rc = piControlWrite(test.vars[i].offset, test.vars[i].length / 8, data);
+		if (rc < 0)
+			goto out;
+	}
+
+	atomic_store(&stress_go, false);
+	atomic_store(&stress_stop, false);
+	rc = pthread_create(&writer, NULL, torn_writer_start, &test);
+	if (rc == 0) {
+		writer_started = true;
+		for (started = 0; started < args->readers; started++) {
+			rc = pthread_create(&readers[started].id, NULL, torn_reader_start,
+					    &readers[started]);
+			if (rc != 0)
+				break;
+		}
+	}
+	if (rc != 0) {
+		fprintf(stderr, "error creating thread: %d (%s)\n", rc, strerror(rc));
+		rc = -rc;
+	} else {
+		start = piImageTimestamp();
+		atomic_store(&stress_go, true);
+		duration.tv_sec = args->seconds;
+		duration.tv_nsec = 0;
+		while (nanosleep(&duration, &duration) < 0 && errno == EINTR)
+			;
+	}
+	atomic_store(&stress_stop, true);
+
+	if (writer_started)
+		pthread_join(writer, NULL);
+	for (i = 0; i < started; i++)
+		pthread_join(readers[i].id, NULL);
+	if (rc < 0)
+		goto out;
+
+	seconds = (piImageTimestamp() - start) / 1e9;
+	printf("%u variables, %u readers, %.1f s, %.0f writes/s\n", test.nvars,
+	       args->readers, seconds, test.writes / seconds);
+
+	rc = 0;
+	for (path = 0; path < TORN_PATHS; path++) {
+		reads = torn = 0;
+		for (i = 0; i < args->readers; i++) {
+			reads += readers[i].reads[path];
+			torn += readers[i].torn[path];
+		}
+		/* a block read checks all variables at once */
+		values = path == TORN_PATH_BLOCK ? reads * test.nvars : reads;
+		printf("%8s reads: %12" PRIu64 " (%10.0f reads/s), torn values: %" PRIu64
+		       " (%.3f per million)\n", path_names[path], reads, reads / seconds,
+		       torn, values ? torn * 1e6 / values : 0.0);
+		if (torn)
+			rc = 1;
+	}
+
+out:
+	if (readers) {
+		for (i = 0; i < args->readers; i++)
+			free(readers[i].buf);
+	}
+	free(readers);
+	free(test.vars);
+	return rc;
+}
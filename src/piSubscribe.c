@@ -0,0 +1,482 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+/*!
+ * Project: piTest
+ * Demo source code for usage of piControl driver
+ *
+ * \file piSubscribe.c
+ *
+ * \brief Subscriptions to the process image
+ *
+ * Variables and regions are subscribed with a period and a callback. An
+ * event loop wakes up whenever a subscription is due, reads the bytes of
+ * all due subscriptions at once, with nearby regions merged into one
+ * access, and calls the callbacks of the subscriptions, optionally only if
+ * their data changed. Each byte is read once per wakeup, however many
+ * subscriptions share it.
+ */
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "piControlIf.h"
+#include "piCycle.h"
+#include "piImage.h"
+#include "piSubscribe.h"
+
+/* regions closer than this are read with one access */
+#define SUBSCRIBE_MERGE_GAP	16
+
+/******************************************************************************/
+/*********************************  Types  ************************************/
+/******************************************************************************/
+
+struct subscription {
+	bool active;
+	bool primed;			/* last holds the data of a previous read */
+	bool is_var;
+	struct pi_var var;
+	uint32_t offset;
+	uint32_t length;
+	uint64_t period_ns;
+	uint64_t next;			/* monotonic time the subscription is due */
+	unsigned int flags;
+	int64_t last_value;
+	uint8_t *last;
+	piSubscribeFn fn;
+	void *ctx;
+};
+
+struct pi_subscribe_loop {
+	struct subscription *subs;
+	unsigned int count;
+	unsigned int size;
+	unsigned int *due;		/* indices of the due subscriptions */
+	struct pi_span *ranges;		/* merged regions of the due subscriptions */
+	struct pi_io *ios;
+	atomic_bool stop;
+	struct pi_subscribe_stats stats;
+	uint8_t image[KB_PI_LEN];
+};
+
+/******************************************************************************/
+/*******************************  Functions  **********************************/
+/******************************************************************************/
+
+struct pi_subscribe_loop *piSubscribeCreate(void)
+{
+	return calloc(1, sizeof(struct pi_subscribe_loop));
+}
+
+void piSubscribeFree(struct pi_subscribe_loop *loop)
+{
+	unsigned int i;
+
+	if (!loop)
+		return;
+
+	for (i = 0; i < loop->count; i++)
+		free(loop->subs[i].last);
+	free(loop->subs);
+	free(loop->due);
+	free(loop->ranges);
+	free(loop->ios);
+	free(loop);
+}
+
+static int add_subscription(struct pi_subscribe_loop *loop, struct subscription *sub)
+{
+	if (sub->length == 0 || sub->offset + sub->length > KB_PI_LEN) {
+		fprintf(stderr, "Invalid region at offset %" PRIu32 " with length %" PRIu32 "\n",
+			sub->offset, sub->length);
+		return -EINVAL;
+	}
+	if (sub->period_ns == 0) {
+		fprintf(stderr, "Invalid period 0\n");
+		return -EINVAL;
+	}
+
+	if (loop->count == loop->size) {
+		unsigned int size = loop->size ? loop->size * 2 : 16;
+		struct subscription *subs = realloc(loop->subs, size * sizeof(*subs));
+		unsigned int *due = realloc(loop->due, size * sizeof(*due));
+		struct pi_span *ranges = realloc(loop->ranges, size * sizeof(*ranges));
+		struct pi_io *ios = realloc(loop->ios, size * sizeof(*ios));
+
+		if (subs)
+			loop->subs = subs;
+		if (due)
+			loop->due = due;
+		if (ranges)
+			loop->ranges = ranges;
+		if (ios)
+			loop->ios = ios;
+		if (!subs || !due || !ranges || !ios)
+			return -ENOMEM;
+		loop->size = size;
+	}
+
+	sub->last = malloc(sub->length);
+	if (!sub->last)
+		return -ENOMEM;
+	sub->active = true;
+	loop->subs[loop->count] = *sub;
+
+	return loop->count++;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Subscribe to a variable
+ *
+ * @param[in]   loop		event loop
+ * @param[in]   spec		variable, see piImageResolve()
+ * @param[in]   period_us	period in which the variable is read
+ * @param[in]   flags		PI_SUBSCRIBE_ON_CHANGE to call back only on changes
+ * @param[in]   fn		callback
+ * @param[in]   ctx		passed to the callback
+ *
+ * @return id of the subscription, < 0 on error
+ *
+ ************************************************************************************/
+int piSubscribeVariable(struct pi_subscribe_loop *loop, const char *spec,
+			uint32_t period_us, unsigned int flags, piSubscribeFn fn, void *ctx)
+{
+	struct subscription sub;
+	int rc;
+
+	memset(&sub, 0, sizeof(sub));
+	rc = piImageResolve(spec, &sub.var);
+	if (rc < 0)
+		return rc;
+
+	sub.is_var = true;
+	sub.offset = sub.var.offset;
+	sub.length = piImageVarBytes(&sub.var);
+	sub.period_ns = (uint64_t)period_us * 1000;
+	sub.flags = flags;
+	sub.fn = fn;
+	sub.ctx = ctx;
+
+	return add_subscription(loop, &sub);
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Subscribe to a region of the process image
+ *
+ * @param[in]   loop		event loop
+ * @param[in]   offset		first byte of the region
+ * @param[in]   length		length of the region in bytes
+ * @param[in]   period_us	period in which the region is read
+ * @param[in]   flags		PI_SUBSCRIBE_ON_CHANGE to call back only on changes
+ * @param[in]   fn		callback
+ * @param[in]   ctx		passed to the callback
+ *
+ * @return id of the subscription, < 0 on error
+ *
+ ************************************************************************************/
+int piSubscribeRegion(struct pi_subscribe_loop *loop, uint32_t offset, uint32_t length,
+		      uint32_t period_us, unsigned int flags, piSubscribeFn fn, void *ctx)
+{
+	struct subscription sub;
+
+	memset(&sub, 0, sizeof(sub));
+	sub.offset = offset;
+	sub.length = length;
+	sub.period_ns = (uint64_t)period_us * 1000;
+	sub.flags = flags;
+	sub.fn = fn;
+	sub.ctx = ctx;
+
+	return add_subscription(loop, &sub);
+}
+
+/***********************************************************************************/
+/*!
+ * @brief End a subscription
+ *
+ * May be called from a callback, also for the subscription being called back.
+ *
+ * @return 0 on success, -ENOENT for an unknown subscription
+ *
+ ************************************************************************************/
+int piUnsubscribe(struct pi_subscribe_loop *loop, int id)
+{
+	if (id < 0 || (unsigned int)id >= loop->count || !loop->subs[id].active)
+		return -ENOENT;
+
+	loop->subs[id].active = false;
+	return 0;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Stop the event loop
+ *
+ * May be called from a callback or from another thread. piSubscribeRun()
+ * returns after its current wakeup.
+ *
+ ************************************************************************************/
+void piSubscribeStop(struct pi_subscribe_loop *loop)
+{
+	atomic_store(&loop->stop, true);
+}
+
+void piSubscribeGetStats(const struct pi_subscribe_loop *loop,
+			 struct pi_subscribe_stats *stats)
+{
+	*stats = loop->stats;
+}
+
+static int compare_span(const void *a, const void *b)
+{
+	const struct pi_span *sa = a, *sb = b;
+
+	return sa->offset < sb->offset ? -1 : sa->offset > sb->offset;
+}
+
+/*
+ * read the regions of all due subscriptions, merging nearby ones, -EIO if
+ * only some of the reads failed
+ */
+static int read_due(struct pi_subscribe_loop *loop, unsigned int ndue)
+{
+	struct subscription *sub;
+	unsigned int i, nranges = 0;
+	uint32_t end;
+	int rc;
+
+	for (i = 0; i < ndue; i++) {
+		sub = &loop->subs[loop->due[i]];
+		loop->ranges[i].offset = sub->offset;
+		loop->ranges[i].length = sub->length;
+	}
+	qsort(loop->ranges, ndue, sizeof(*loop->ranges), compare_span);
+
+	for (i = 0; i < ndue; i++) {
+		struct pi_span *last = nranges ? &loop->ranges[nranges - 1] : NULL;
+
+		end = loop->ranges[i].offset + loop->ranges[i].length;
+		if (last && loop->ranges[i].offset <= last->offset + last->length + SUBSCRIBE_MERGE_GAP) {
+			if (end > last->offset + last->length)
+				last->length = end - last->offset;
+		} else {
+			loop->ranges[nranges++] = loop->ranges[i];
+		}
+	}
+
+	for (i = 0; i < nranges; i++) {
+		loop->ios[i].offset = loop->ranges[i].offset;
+		loop->ios[i].length = loop->ranges[i].length;
+		loop->ios[i].data = loop->image + loop->ranges[i].offset;
+		loop->ios[i].write = false;
+		loop->stats.bytes += loop->ranges[i].length;
+	}
+	loop->stats.reads += nranges;
+
+	rc = piControlTransfer(loop->ios, nranges);
+	if (rc == -EIO) {
+		for (i = 0; i < nranges; i++) {
+			if (loop->ios[i].result == -EBADF || loop->ios[i].result == -ENODEV)
+				return loop->ios[i].result;
+		}
+	}
+	return rc;
+}
+
+static void dispatch(struct pi_subscribe_loop *loop, unsigned int index, uint64_t timestamp)
+{
+	struct subscription *sub = &loop->subs[index];
+	struct pi_subscribe_event ev;
+	const uint8_t *data = loop->image + sub->offset;
+	/* the callback may add subscriptions, which moves sub */
+	struct pi_var var = sub->var;
+	bool changed;
+
+	ev.timestamp = timestamp;
+	ev.id = index;
+	ev.var = sub->is_var ? &var : NULL;
+	ev.value = sub->is_var ? piImageValue(loop->image, 0, &sub->var) : 0;
+	ev.offset = sub->offset;
+	ev.length = sub->length;
+	ev.data = data;
+
+	/* a variable changes with its value, not with other bits of its byte */
+	if (sub->is_var)
+		changed = !sub->primed || ev.value != sub->last_value;
+	else
+		changed = !sub->primed || memcmp(sub->last, data, sub->length);
+	if (changed) {
+		sub->last_value = ev.value;
+		memcpy(sub->last, data, sub->length);
+		sub->primed = true;
+	}
+
+	if (changed || !(sub->flags & PI_SUBSCRIBE_ON_CHANGE)) {
+		loop->stats.events++;
+		sub->fn(sub->ctx, &ev);
+	}
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Run the event loop
+ *
+ * All subscriptions are due immediately, afterwards each one is due once
+ * per period. A subscription which could not be served in time skips the
+ * missed periods. A failed read skips the callbacks of the wakeup and is
+ * counted in the errors of the statistics. Subscriptions may be added and
+ * ended from the callbacks.
+ *
+ * @param[in]   loop	event loop
+ *
+ * @return 0 when stopped or no subscription is left, < 0 if the device
+ *         cannot be read anymore
+ *
+ ************************************************************************************/
+int piSubscribeRun(struct pi_subscribe_loop *loop)
+{
+	struct subscription *sub;
+	struct timespec ts;
+	uint64_t now, next;
+	unsigned int i, ndue;
+	int rc;
+
+	now = piImageTimestamp();
+	for (i = 0; i < loop->count; i++)
+		loop->subs[i].next = now;
+	atomic_store(&loop->stop, false);
+
+	while (!atomic_load(&loop->stop) && !piCycleStopped()) {
+		next = UINT64_MAX;
+		for (i = 0; i < loop->count; i++) {
+			if (loop->subs[i].active && loop->subs[i].next < next)
+				next = loop->subs[i].next;
+		}
+		if (next == UINT64_MAX)
+			break;
+
+		ts.tv_sec = next / 1000000000;
+		ts.tv_nsec = next % 1000000000;
+		rc = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+		if (rc == EINTR)
+			continue;
+
+		now = piImageTimestamp();
+		loop->stats.cycles++;
+		ndue = 0;
+		for (i = 0; i < loop->count; i++) {
+			sub = &loop->subs[i];
+			if (!sub->active || sub->next > now)
+				continue;
+			loop->due[ndue++] = i;
+			sub->next += sub->period_ns;
+			while (sub->next <= now) {
+				sub->next += sub->period_ns;
+				loop->stats.misses++;
+			}
+		}
+
+		/* a failed read skips the wakeup, unless the device is gone */
+		rc = read_due(loop, ndue);
+		if (rc == -EIO) {
+			loop->stats.errors++;
+			continue;
+		}
+		if (rc < 0) {
+			fprintf(stderr, "Failed to read subscribed data: %s\n", strerror(-rc));
+			return rc;
+		}
+
+		now = piImageTimestamp();
+		for (i = 0; i < ndue; i++) {
+			if (loop->subs[loop->due[i]].active)
+				dispatch(loop, loop->due[i], now);
+		}
+	}
+
+	return 0;
+}
+
+/* ctx holds the difference between wall clock and monotonic clock */
+static void print_change(void *ctx, const struct pi_subscribe_event *ev)
+{
+	uint64_t wall = ev->timestamp + *(int64_t *)ctx;
+
+	printf("%" PRIu64 ".%06" PRIu64 " %s %" PRId64 "\n",
+	       wall / 1000000000, (wall % 1000000000) / 1000, ev->var->name, ev->value);
+	fflush(stdout);
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Print the changes of variables
+ *
+ * @param[in]   specs		comma separated variables, each optionally followed
+ *				by @<period in ms>, see piImageResolve()
+ * @param[in]   period_us	period of variables without an own period
+ *
+ * @return 0 on success, < 0 on error
+ *
+ ************************************************************************************/
+int piSubscribeWatch(const char *specs, uint32_t period_us)
+{
+	struct pi_subscribe_loop *loop;
+	int64_t wall_offset;
+	char *buf, *spec, *at, *end, *saveptr = NULL;
+	unsigned long period_ms;
+	int rc = 0;
+
+	buf = strdup(specs);
+	loop = piSubscribeCreate();
+	if (!buf || !loop) {
+		fprintf(stderr, "Not enough memory\n");
+		rc = -ENOMEM;
+		goto out;
+	}
+
+	wall_offset = piImageWallclock() - piImageTimestamp();
+	for (spec = strtok_r(buf, ",", &saveptr); spec; spec = strtok_r(NULL, ",", &saveptr)) {
+		uint32_t period = period_us;
+
+		at = strchr(spec, '@');
+		/* '@' at the start is an address, not a period */
+		if (at == spec)
+			at = strchr(spec + 1, '@');
+		if (at) {
+			*at = '\0';
+			period_ms = strtoul(at + 1, &end, 10);
+			if (*end || period_ms == 0 || period_ms > UINT32_MAX / 1000) {
+				fprintf(stderr, "Invalid period '%s'\n", at + 1);
+				rc = -EINVAL;
+				goto out;
+			}
+			period = period_ms * 1000;
+		}
+
+		rc = piSubscribeVariable(loop, spec, period, PI_SUBSCRIBE_ON_CHANGE,
+					 print_change, &wall_offset);
+		if (rc < 0)
+			goto out;
+	}
+
+	piCycleCatchSignals();
+	rc = piSubscribeRun(loop);
+
+out:
+	piSubscribeFree(loop);
+	free(buf);
+	return rc;
+}
@@ -22,28 +22,115 @@
 #include <sys/types.h>
 #include <stdbool.h>
 #include <errno.h>
+#include <inttypes.h>
 #include <pthread.h>
+#include <signal.h>
 
 #include "piControlIf.h"
 #include "piControl.h"
 #include "common_define.h"
+#include "piTest.h"
+#include "piMonitor.h"
+#include "piLogic.h"
+#include "piCycle.h"
+#include "piBridge.h"
+#include "piStress.h"
+#include "piSubscribe.h"
+#include "piImage.h"
+#include "piSampler.h"
+#include "piFormat.h"
+#include "piColumnar.h"
+#include "piCapture.h"
+#include "piScope.h"
+#include "piWindow.h"
+#include "piUnits.h"
+#include "piSchema.h"
+#include "piModule.h"
+#include "piCounter.h"
+#include "piRelay.h"
+#include "piTop.h"
 
 #define PROGRAM_VERSION		"2.1.1"
 
 #define SEC_AS_USEC 1000000
+#define READ_DEFAULT_INTERVAL_USEC SEC_AS_USEC
 #define NUM_SPINS_PER_SECOND 16
+#define MONITOR_DEFAULT_INTERVAL_USEC 10000
+#define LOGIC_DEFAULT_INTERVAL_USEC 10000
+#define WATCH_DEFAULT_INTERVAL_USEC 10000
+#define SCOPE_DEFAULT_INTERVAL_USEC 1000
+#define WINDOW_DEFAULT_INTERVAL_USEC 1000
+#define COUNTERS_DEFAULT_INTERVAL_USEC 10000
+#define TOP_DEFAULT_INTERVAL_USEC 100000
 
 /* long option names */
 # define MODULE_LONG_ARG_NAME "module"
 # define FORCE_LONG_ARG_NAME "force"
 # define ASSUME_YES_LONG_ARG_NAME "assume-yes"
 # define RESCUE_LONG_ARG_NAME "rescue"
+# define INTERVAL_LONG_ARG_NAME "interval"
+# define MONITOR_LONG_ARG_NAME "monitor"
+# define LOGIC_LONG_ARG_NAME "logic"
+# define RT_LONG_ARG_NAME "rt"
+# define BRIDGE_PROFILE_LONG_ARG_NAME "bridge-profile"
+# define CONTENTION_LONG_ARG_NAME "contention"
+# define TORN_LONG_ARG_NAME "torn"
+# define STATS_LONG_ARG_NAME "stats"
+# define WATCH_LONG_ARG_NAME "watch"
+# define FORMAT_LONG_ARG_NAME "format"
+# define COLUMNAR_LONG_ARG_NAME "columnar"
+# define DECODE_LONG_ARG_NAME "decode"
+# define QUERY_LONG_ARG_NAME "query"
+# define VAR_LONG_ARG_NAME "var"
+# define FROM_LONG_ARG_NAME "from"
+# define TO_LONG_ARG_NAME "to"
+# define AGGREGATE_LONG_ARG_NAME "aggregate"
+# define TRIGGER_LONG_ARG_NAME "trigger"
+# define SCOPE_LONG_ARG_NAME "scope"
+# define WINDOW_LONG_ARG_NAME "window"
+# define UNITS_LONG_ARG_NAME "units"
+# define SCHEMA_LONG_ARG_NAME "schema"
+# define MODULES_LONG_ARG_NAME "modules"
+# define COUNTERS_LONG_ARG_NAME "counters"
+# define RO_COUNTERS_LONG_ARG_NAME "ro-counters"
+# define TOP_LONG_ARG_NAME "top"
 
 /* long option indices */
 # define MODULE_LONG_ARG_INDEX 0
 # define FORCE_LONG_ARG_INDEX  1
 # define ASSUME_YES_LONG_ARG_INDEX 2
 # define RESCUE_LONG_ARG_INDEX 3
+# define INTERVAL_LONG_ARG_INDEX 4
+# define MONITOR_LONG_ARG_INDEX 5
+# define LOGIC_LONG_ARG_INDEX 6
+# define RT_LONG_ARG_INDEX 7
+# define BRIDGE_PROFILE_LONG_ARG_INDEX 8
+# define CONTENTION_LONG_ARG_INDEX 9
+# define TORN_LONG_ARG_INDEX 10
+# define STATS_LONG_ARG_INDEX 11
+# define WATCH_LONG_ARG_INDEX 12
+# define FORMAT_LONG_ARG_INDEX 13
+# define COLUMNAR_LONG_ARG_INDEX 14
+# define DECODE_LONG_ARG_INDEX 15
+# define QUERY_LONG_ARG_INDEX 16
+# define VAR_LONG_ARG_INDEX 17
+# define FROM_LONG_ARG_INDEX 18
+# define TO_LONG_ARG_INDEX 19
+# define AGGREGATE_LONG_ARG_INDEX 20
+# define TRIGGER_LONG_ARG_INDEX 21
+# define SCOPE_LONG_ARG_INDEX 22
+# define WINDOW_LONG_ARG_INDEX 23
+# define UNITS_LONG_ARG_INDEX 24
+# define SCHEMA_LONG_ARG_INDEX 25
+# define MODULES_LONG_ARG_INDEX 26
+# define COUNTERS_LONG_ARG_INDEX 27
+# define RO_COUNTERS_LONG_ARG_INDEX 28
+# define TOP_LONG_ARG_INDEX 29
+
+/* maximum number of --var options of a query */
+#define QUERY_MAX_VARS 64
+/* maximum number of --trigger options */
+#define SCOPE_MAX_TRIGGERS 16
 
 /***********************************************************************************/
 /*!
@@ -212,76 +299,233 @@ int showDeviceList(void)
 	return devcount;
 }
 
+/* print one sample of readData() */
+static void printData(const uint8_t *pValues, uint16_t length, char format)
+{
+	int val;
+	int line_len = 10;	// for decimal
+	if (format == 'h')
+		line_len = 16;
+	else if (format == 'b')
+		line_len = 4;
+
+	for (val = 0; val < length; val++) {
+		if (format == 'h') {
+			printf("%02x ", pValues[val]);
+		} else if (format == 'b') {
+			printf("%c%c%c%c%c%c%c%c ",
+				pValues[val] & 0x80 ? '1' : '0',
+				pValues[val] & 0x40 ? '1' : '0',
+				pValues[val] & 0x20 ? '1' : '0',
+				pValues[val] & 0x10 ? '1' : '0',
+				pValues[val] & 0x08 ? '1' : '0',
+				pValues[val] & 0x04 ? '1' : '0',
+				pValues[val] & 0x02 ? '1' : '0',
+				pValues[val] & 0x01 ? '1' : '0');
+		} else if (format == 's') {
+			uint16_t ui;
+			int16_t *psi;
+			ui = pValues[val] + (pValues[val + 1] << 8);
+			psi = (int16_t *) & ui;
+			printf("%6d ", *psi);
+			val++;
+		} else {
+			printf("%3d ", pValues[val]);
+		}
+		if ((val % line_len) == (line_len - 1))
+			printf("\n");
+	}
+	if ((val % line_len) != 0)
+		printf("\n");
+}
+
+struct read_output {
+	struct pi_format *fmt;		/* NULL for the output of readData() */
+	uint16_t length;
+	char format;
+};
+
+static void read_output(void *ctx, uint64_t timestamp, const uint8_t *sample)
+{
+	struct read_output *out = ctx;
+
+	if (out->fmt)
+		piFormatSample(out->fmt, timestamp, sample);
+	else
+		printData(sample, out->length, out->format);
+}
+
+static void read_flush(void *ctx)
+{
+	struct read_output *out = ctx;
+
+	if (out->fmt)
+		piFormatFlush(out->fmt);
+}
+
+/* read <length> bytes at <offset> every period, written by an output thread */
+static int read_cyclic(uint16_t offset, struct read_output *out, uint32_t period_us)
+{
+	struct pi_sampler sampler = {
+		.output = read_output,
+		.flush = read_flush,
+		.ctx = out,
+	};
+	int rc;
+
+	rc = piSamplerStart(&sampler, 0, out->length);
+	if (rc < 0)
+		return rc;
+	rc = piSamplerRead(&sampler, offset, out->length, period_us);
+	piSamplerStop(&sampler);
+
+	return rc;
+}
+
 /***********************************************************************************/
 /*!
  * @brief Read data
  *
  * Read <length> bytes at a specific offset.
  *
+ * Cyclic reads are done by the calling thread, which passes the samples
+ * through a ring to an output thread. A slow output therefore does not
+ * delay the reads; samples are dropped and counted if the ring is full.
+ *
  * @param[in]   Offset
  * @param[in]   Length
+ * @param[in]   Cycle time in microseconds
  *
  ************************************************************************************/
-int readData(uint16_t offset, uint16_t length, bool cyclic, char format, bool quiet)
+int readData(uint16_t offset, uint16_t length, bool cyclic, char format, bool quiet,
+	     uint32_t period_us)
 {
-	int rc;
+	struct read_output out;
 	uint8_t *pValues;
-	int val;
-	int line_len = 10;	// for decimal
-	if (format == 'h')
-		line_len = 16;
-	else if (format == 'b')
-		line_len = 4;
+	int rc;
+
+	if (cyclic) {
+		out.fmt = NULL;
+		out.length = length;
+		out.format = format;
+		return read_cyclic(offset, &out, period_us);
+	}
 
-	// Get memory for the values
 	pValues = malloc(length);
 	if (pValues == NULL) {
 		fprintf(stderr, "Not enough memory\n");
 		return -ENOMEM;
 	}
 
-	do {
-		rc = piControlRead(offset, length, pValues);
-		if (rc < 0) {
-			if (!quiet) {
-				if (!cyclic)
-					return rc;
-			}
+	rc = piControlRead(offset, length, pValues);
+	if (rc >= 0)
+		printData(pValues, length, format);
+	free(pValues);
+
+	return rc < 0 && !quiet ? rc : 0;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Read data in a machine readable format
+ *
+ * The argument of -r is either "<offset>,<length>[,s]", which reads bytes,
+ * or signed words with s, or a comma separated list of variables as
+ * accepted by piImageResolve(). A single letter after the last variable is
+ * the format of the text output and ignored.
+ *
+ * @param[in]   spec		argument of -r
+ * @param[in]   cyclic		read until Ctrl-C is pressed
+ * @param[in]   type		output format
+ * @param[in]   period_us	cycle time in microseconds
+ *
+ * @return 0 on success, < 0 on error
+ *
+ ************************************************************************************/
+int readFormatted(const char *spec, bool cyclic, enum pi_format_type type, uint32_t period_us)
+{
+	struct pi_var_table table = { 0 };
+	struct read_output out;
+	struct pi_format *fmt;
+	char name[32];
+	char *specs, *tok, *saveptr;
+	unsigned int offset, length, i;
+	uint8_t *pValues;
+	char format = 'd';
+	int rc = 0;
+
+	if (isdigit((unsigned char)spec[0]) &&
+	    sscanf(spec, "%u,%u,%c", &offset, &length, &format) >= 2) {
+		bool words = format == 's';
+
+		if (length == 0 || offset + length > KB_PI_LEN) {
+			fprintf(stderr, "Invalid region %u,%u\n", offset, length);
+			return -EINVAL;
+		}
+		for (i = 0; rc >= 0 && i + words < length; i += 1 + words) {
+			snprintf(name, sizeof(name), words ? "@%u/16:s" : "@%u", offset + i);
+			rc = piVarTableAdd(&table, name);
+		}
+	} else {
+		specs = strdup(spec);
+		if (specs == NULL) {
+			fprintf(stderr, "Not enough memory\n");
+			return -ENOMEM;
+		}
+		for (tok = strtok_r(specs, ",", &saveptr); rc >= 0 && tok;
+		     tok = strtok_r(NULL, ",", &saveptr)) {
+			if (tok[1] == '\0' && table.count && strchr("hdbs", tok[0]))
+				continue;
+			rc = piVarTableAdd(&table, tok);
+		}
+		free(specs);
+	}
+	if (rc < 0 || table.count == 0) {
+		piVarTableFree(&table);
+		return rc < 0 ? rc : -EINVAL;
+	}
+
+	fmt = malloc(sizeof(*fmt));
+	if (fmt == NULL) {
+		fprintf(stderr, "Not enough memory\n");
+		piVarTableFree(&table);
+		return -ENOMEM;
+	}
+	rc = piFormatInit(fmt, type, STDOUT_FILENO, table.vars, table.count);
+	if (rc < 0) {
+		free(fmt);
+		piVarTableFree(&table);
+		return rc;
+	}
+	fflush(stdout);
+	piFormatHeader(fmt);
+
+	if (cyclic) {
+		out.fmt = fmt;
+		out.length = fmt->length;
+		rc = read_cyclic(fmt->offset, &out, period_us);
+	} else {
+		pValues = malloc(fmt->length);
+		if (pValues == NULL) {
+			fprintf(stderr, "Not enough memory\n");
+			rc = -ENOMEM;
 		} else {
-			for (val = 0; val < length; val++) {
-				if (format == 'h') {
-					printf("%02x ", pValues[val]);
-				} else if (format == 'b') {
-					printf("%c%c%c%c%c%c%c%c ",
-						pValues[val] & 0x80 ? '1' : '0',
-						pValues[val] & 0x40 ? '1' : '0',
-						pValues[val] & 0x20 ? '1' : '0',
-						pValues[val] & 0x10 ? '1' : '0',
-						pValues[val] & 0x08 ? '1' : '0',
-						pValues[val] & 0x04 ? '1' : '0',
-						pValues[val] & 0x02 ? '1' : '0',
-						pValues[val] & 0x01 ? '1' : '0');
-				} else if (format == 's') {
-					uint16_t ui;
-					int16_t *psi;
-					ui = pValues[val] + (pValues[val + 1] << 8);
-					psi = (int16_t *) & ui;
-					printf("%6d ", *psi);
-					val++;
-				} else {
-					printf("%3d ", pValues[val]);
-				}
-				if ((val % line_len) == (line_len - 1))
-					printf("\n");
-			}
-			if ((val % line_len) != 0)
-				printf("\n");
+			rc = piControlRead(fmt->offset, fmt->length, pValues);
+			if (rc >= 0)
+				rc = piFormatSample(fmt, piImageTimestamp(), pValues);
+			free(pValues);
 		}
-		if (cyclic)
-			sleep(1);
-	} while (cyclic);
+	}
 
-	return 0;
+	if (piFormatFinish(fmt) < 0) {
+		fprintf(stderr, "Failed to write output: %s\n", strerror(-fmt->error));
+		if (rc >= 0)
+			rc = fmt->error;
+	}
+	free(fmt);
+	piVarTableFree(&table);
+
+	return rc < 0 ? rc : 0;
 }
 
 /***********************************************************************************/
@@ -291,10 +535,13 @@ int readData(uint16_t offset, uint16_t length, bool cyclic, char format, bool qu
  * Read the value of a variable from process image
  *
  * @param[in]   Variable name
+ * @param[in]   Cycle time in microseconds
  *
  ************************************************************************************/
-int readVariableValue(char *pszVariableName, bool cyclic, char format, bool quiet)
+int readVariableValue(char *pszVariableName, bool cyclic, char format, bool quiet,
+		      uint32_t period_us)
 {
+	struct pi_cycle cycle;
 	int rc;
 	SPIVariable sPiVariable;
 	SPIValue sPIValue;
@@ -308,6 +555,11 @@ int readVariableValue(char *pszVariableName, bool cyclic, char format, bool quie
 		fprintf(stderr, "Failed to find variable '%s'\n", pszVariableName);
 		return rc;
 	}
+	if (cyclic) {
+		rc = piCycleStart(&cycle, period_us);
+		if (rc < 0)
+			return rc;
+	}
 	if (sPiVariable.i16uLength == 1) {
 		sPIValue.i16uAddress = sPiVariable.i16uAddress;
 		sPIValue.i8uBit = sPiVariable.i8uBit;
@@ -324,9 +576,7 @@ int readVariableValue(char *pszVariableName, bool cyclic, char format, bool quie
 				else
 					printf("%d\n", sPIValue.i8uValue);
 			}
-			if (cyclic)
-				sleep(1);
-		} while (cyclic);
+		} while (cyclic && piCycleWait(&cycle));
 	} else if (sPiVariable.i16uLength == 8) {
 		do {
 			rc = piControlRead(sPiVariable.i16uAddress, 1, (uint8_t *) & i8uValue);
@@ -362,9 +612,7 @@ int readVariableValue(char *pszVariableName, bool cyclic, char format, bool quie
 						printf("%d\n", i8uValue);
 				}
 			}
-			if (cyclic)
-				sleep(1);
-		} while (cyclic);
+		} while (cyclic && piCycleWait(&cycle));
 	} else if (sPiVariable.i16uLength == 16) {
 		do {
 			rc = piControlRead(sPiVariable.i16uAddress, 2, (uint8_t *) & i16uValue);
@@ -410,9 +658,7 @@ int readVariableValue(char *pszVariableName, bool cyclic, char format, bool quie
 						printf("%d\n", i16uValue);
 				}
 			}
-			if (cyclic)
-				sleep(1);
-		} while (cyclic);
+		} while (cyclic && piCycleWait(&cycle));
 	} else if (sPiVariable.i16uLength == 32) {
 		do {
 			rc = piControlRead(sPiVariable.i16uAddress, 4, (uint8_t *) & i32uValue);
@@ -478,9 +724,7 @@ int readVariableValue(char *pszVariableName, bool cyclic, char format, bool quie
 						printf("%d\n", i32uValue);
 				}
 			}
-			if (cyclic)
-				sleep(1);
-		} while (cyclic);
+		} while (cyclic && piCycleWait(&cycle));
 	} else {
 		fprintf(stderr,
 			"Got invalid length %u for read variable %s\n",
@@ -488,6 +732,9 @@ int readVariableValue(char *pszVariableName, bool cyclic, char format, bool quie
 		return -1;
 	}
 
+	if (cyclic)
+		piCycleFinish(&cycle);
+
 	return 0;
 }
 
@@ -686,6 +933,8 @@ int showVariableInfo(char *pszVariableName)
 	return 0;
 }
 
+/* the command line interface, left out when the functions above are linked into piTestBench */
+#ifndef PITEST_NO_MAIN
 static void printVersion(char *programname)
 {
 	printf("%s version %s\n", programname, PROGRAM_VERSION);
@@ -711,6 +960,62 @@ static void *spinner_thread_start(void *arg)
 	}
 }
 
+static void print_stats(void)
+{
+	fflush(stdout);
+	piControlStatsPrint(stderr);
+}
+
+static void *stats_thread_start(void *arg)
+{
+	sigset_t *set = arg;
+	int sig;
+
+	while (sigwait(set, &sig) == 0)
+		print_stats();
+
+	return NULL;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Collect statistics of driver calls
+ *
+ * The statistics are printed to stderr at exit and whenever SIGUSR1 is
+ * received. SIGUSR1 is blocked in all threads and handled by a thread of its
+ * own, which can print safely while other threads keep running.
+ *
+ * @return 0 on success, < 0 on error
+ *
+ ************************************************************************************/
+static int enableStats(void)
+{
+	static sigset_t set;
+	static bool enabled;
+	pthread_t stats_thread_id;
+	int rc;
+
+	if (enabled)
+		return 0;
+
+	sigemptyset(&set);
+	sigaddset(&set, SIGUSR1);
+	rc = pthread_sigmask(SIG_BLOCK, &set, NULL);
+	if (rc == 0)
+		rc = pthread_create(&stats_thread_id, NULL, stats_thread_start, &set);
+	if (rc != 0) {
+		fprintf(stderr, "error creating statistics thread: %d (%s)\n", rc, strerror(rc));
+		return -rc;
+	}
+	pthread_detach(stats_thread_id);
+
+	piControlStatsEnable(true);
+	atexit(print_stats);
+	enabled = true;
+
+	return 0;
+}
+
 static int handleFirmwareUpdate(int module_address, int force_update,
 				int hw_revision, int assume_yes, bool quiet)
 {
@@ -802,14 +1107,15 @@ void printHelp(char *programname)
 	printf("                     <f> defines the format: h for hex, d for decimal (default), b for binary\n");
 	printf("                     E.g.: -r Input_001,h\n");
 	printf("                     Read value from variable 'Input_001'.\n");
-	printf("                     Shows values cyclically every second.\n");
+	printf("                     Shows values cyclically every second or every --interval.\n");
 	printf("                     Break with Ctrl-C.\n");
 	printf("\n");
 	printf("   -r <o>,<l>[,<f>]: Reads <l> bytes at offset <o>.\n");
 	printf("                     <f> defines the format: h for hex, d for decimal (default), b for binary\n");
 	printf("                     E.g.: -r 1188,16\n");
 	printf("                     Read 16 bytes at offset 1188.\n");
-	printf("                     Shows values cyclically every second.\n");
+	printf("                     Shows values cyclically every second or every --interval.\n");
+	printf("                     Samples the output cannot keep up with are dropped and counted.\n");
 	printf("                     Break with Ctrl-C.\n");
 	printf("\n");
 	printf("  -w <var_name>,<v>: Writes value <v> to variable.\n");
@@ -872,6 +1178,144 @@ void printHelp(char *programname)
 	printf("                     <m> is the mode\n");
 	printf("                     <x> is the check point on x axix\n");
 	printf("                     <y> is the check point on y axis\n");
+	printf("\n");
+	printf("  --interval <usec>: Cycle time in microseconds for the following cyclic command.\n");
+	printf("                     E.g.: --interval 1000 --monitor rules.txt\n");
+	printf("\n");
+	printf("  --rt <prio>[,<cpu>]: Run the following cyclic command with realtime profile:\n");
+	printf("                     SCHED_FIFO priority <prio>, pinned to <cpu>, memory locked and prefaulted.\n");
+	printf("                     Deadline misses and wakeup latencies are reported at the end (Ctrl-C).\n");
+	printf("                     E.g.: --rt 80,3 --interval 1000 -r 0,16\n");
+	printf("\n");
+	printf("   --monitor <file>: Evaluate the alarm rules in <file> cyclically and print\n");
+	printf("                     a timestamped event on every transition. One rule per line:\n");
+	printf("                       edge <var> rising|falling|both\n");
+	printf("                       above <var> <threshold> [<hysteresis>]\n");
+	printf("                       below <var> <threshold> [<hysteresis>]\n");
+	printf("                       rate <var> <change per second> [<hysteresis>]\n");
+	printf("                     <var> is a variable name or @<o>[.<b>|/<bits>], append :s for signed values.\n");
+	printf("                     The default cycle time is %d usec. Break with Ctrl-C.\n",
+	       MONITOR_DEFAULT_INTERVAL_USEC);
+	printf("\n");
+	printf("     --logic <file>: Execute the logic rules in <file> cyclically. One rule per line:\n");
+	printf("                       <output> = <expression>\n");
+	printf("                     Expressions use C operators and min(), max(), abs() on variables and constants.\n");
+	printf("                     E.g.: O_1 = I_1 && !I_2\n");
+	printf("                     All variables are read with one read per cycle, only the outputs are\n");
+	printf("                     written back. The default cycle time is %d usec.\n",
+	       LOGIC_DEFAULT_INTERVAL_USEC);
+	printf("                     Break with Ctrl-C.\n");
+	printf("\n");
+	printf("--bridge-profile <s>: Sample the inputs of all modules for <s> seconds and estimate\n");
+	printf("                     the piBridge cycle time and jitter per module from input changes.\n");
+	printf("                     Samples as fast as possible unless --interval is given before.\n");
+	printf("\n");
+	printf("  --contention <r>,<w>,<o>,<l>[,<s>[,<flags>]]: Benchmark concurrent driver accesses.\n");
+	printf("                     Up to <r> reader and <w> writer threads access the <l> bytes at offset <o>,\n");
+	printf("                     doubling the thread count every <s> seconds (default 2).\n");
+	printf("                     <flags>: o for overlapping instead of disjoint regions,\n");
+	printf("                     b for bit ioctls instead of read/write.\n");
+	printf("                     Writers write back the initial content of the region.\n");
+	printf("\n");
+	printf("  --torn <r>,<s>,<var>[,<var>...]: Check that 16 and 32 bit variables are read atomically.\n");
+	printf("                     A writer thread writes self-checking patterns to the variables while\n");
+	printf("                     <r> reader threads read them for <s> seconds, one by one and as one block.\n");
+	printf("                     The variables are overwritten. Exits with 1 if torn values were seen.\n");
+	printf("\n");
+	printf("            --stats: Count calls, bytes, errors and latencies of the driver calls\n");
+	printf("                     made by the following commands, print them to stderr at exit\n");
+	printf("                     and whenever SIGUSR1 is received.\n");
+	printf("\n");
+	printf("  --watch <var>[@<ms>][,<var>[@<ms>]...]: Print a timestamped line whenever one of the\n");
+	printf("                     variables changes. Each variable is checked every <ms> milliseconds,\n");
+	printf("                     by default with the interval given by --interval or every %d ms.\n",
+	       WATCH_DEFAULT_INTERVAL_USEC / 1000);
+	printf("                     Variables which are due at the same time are read together.\n");
+	printf("                     Break with Ctrl-C.\n");
+	printf("\n");
+	printf("    --format <type>: Output format of the following -r or --decode command: text\n");
+	printf("                     (default), ndjson, csv, bin or cap, a compressed capture with\n");
+	printf("                     keyframes and changes only. -r then takes a list of variables\n");
+	printf("                     <var>[,<var>...] or <o>,<l>[,s], each sample is timestamped.\n");
+	printf("                     E.g.: --format csv -r Input_1,Counter_1\n");
+	printf("\n");
+	printf("  --columnar <rec>,<out>: Convert the recording <rec> written with --format bin\n");
+	printf("                     into the columnar file <out> with one array per variable\n");
+	printf("                     and one of timestamps, dictionary or delta encoded.\n");
+	printf("\n");
+	printf("    --decode <file>: Decode the capture <file> written with --format cap in the format\n");
+	printf("                     given by a preceding --format, CSV by default.\n");
+	printf("\n");
+	printf("     --query <file>: Print the samples of the capture <file> of the variables given\n");
+	printf("                     with --var <var>[,<var>...], all by default, from --from <t0>\n");
+	printf("                     to --to <t1>, seeking with the keyframe index. Times are given\n");
+	printf("                     as seconds since the epoch, YYYY-MM-DDTHH:MM:SS[.frac] local\n");
+	printf("                     time or +seconds since the start of the capture. --aggregate\n");
+	printf("                     prints minimum, maximum and mean instead of the samples.\n");
+	printf("                     E.g.: --query log.cap --var Input_1 --from +3600 --to +3601\n");
+	printf("\n");
+	printf("   --trigger <rule>: Trigger of the following --scope, a rule as used by --monitor.\n");
+	printf("                     May be given more than once.\n");
+	printf("\n");
+	printf("  --scope <pre>,<post>,<var>[,<var>...]: Sample the variables every --interval or\n");
+	printf("                     every %d us and keep the last <pre> samples. When a trigger\n",
+	       SCOPE_DEFAULT_INTERVAL_USEC);
+	printf("                     fires, write them and <post> more samples in the format given by\n");
+	printf("                     --format, CSV by default. With -1 stop after the first window.\n");
+	printf("                     E.g.: --trigger 'edge I_1 rising' --scope 100,50,AIn_1\n");
+	printf("\n");
+	printf("  --window <ms>,<var>[,<var>...]: Sample the variables every --interval or every\n");
+	printf("                     %d us and print the number of samples, minimum, maximum, mean,\n",
+	       WINDOW_DEFAULT_INTERVAL_USEC);
+	printf("                     standard deviation and RMS of each variable every <ms>\n");
+	printf("                     milliseconds, as text, ndjson or csv as given by --format.\n");
+	printf("                     With -1 stop after the first window.\n");
+	printf("                     E.g.: --window 1000,AIn_1,AIn_2\n");
+	printf("\n");
+	printf("     --units <file>: Read the variables of the scaling table <file> every --interval\n");
+	printf("                     or every second and print them in engineering units, as text,\n");
+	printf("                     ndjson or csv as given by --format. Each line of the table is\n");
+	printf("                     '<var>[:s] <gain> <offset> [<unit>]', the value is\n");
+	printf("                     raw * gain + offset. With -1 read only once.\n");
+	printf("                     E.g.: --units analog.units\n");
+	printf("\n");
+	printf("  --schema <file>[,<o>]: Read the region at offset <o>, 0 by default, every\n");
+	printf("                     --interval or every second and print it decoded into the\n");
+	printf("                     typed fields of the schema <file>, as text, ndjson or csv as\n");
+	printf("                     given by --format. Each line of the schema is\n");
+	printf("                     '<name> <type> <offset>[.<bit>]' with the types u8, s8, u16,\n");
+	printf("                     s16, u32, s32, f32, bool and bits<n>, or 'var <var>' for a\n");
+	printf("                     variable of the configuration. With -1 read only once.\n");
+	printf("                     E.g.: --schema aio.schema,11\n");
+	printf("\n");
+	printf("  --modules <addr>[,<addr>...]|all: Read the modules every --interval or every\n");
+	printf("                     second with one read per module and print their inputs and\n");
+	printf("                     outputs decoded into named fields by their module type, as text,\n");
+	printf("                     ndjson or csv as given by --format. Blocks of module types\n");
+	printf("                     without a known layout are printed as bytes.\n");
+	printf("                     With -1 read only once.\n");
+	printf("                     E.g.: -1 --modules all\n");
+	printf("\n");
+	printf(" --counters <ms>[,reset]: Read the counters of all DIO and DI modules every\n");
+	printf("                     --interval or every %d us with one read and print the value,\n",
+	       COUNTERS_DEFAULT_INTERVAL_USEC);
+	printf("                     the pulses and the rate in Hz of each counter every <ms>\n");
+	printf("                     milliseconds, as text, ndjson or csv as given by --format.\n");
+	printf("                     With reset the counters are reset after every window.\n");
+	printf("                     With -1 stop after the first window.\n");
+	printf("                     E.g.: --counters 1000,reset\n");
+	printf("\n");
+	printf("--ro-counters[=<state>]: Print the relay counters of all RO modules, as text, ndjson\n");
+	printf("                     or csv as given by --format. With a <state> file the counters\n");
+	printf("                     are stored and the next run prints the difference and the\n");
+	printf("                     switching rate in cycles per hour of every relay.\n");
+	printf("                     E.g.: --format csv --ro-counters=/var/lib/relays.state\n");
+	printf("\n");
+	printf("              --top: Show the inputs and outputs of all modules in a live full\n");
+	printf("                     screen view, refreshed every --interval or every %d us.\n",
+	       TOP_DEFAULT_INTERVAL_USEC);
+	printf("                     Only the changed values are redrawn.\n");
+	printf("                     E.g.: --interval 50000 --top\n");
 }
 
 /***********************************************************************************/
@@ -900,6 +1344,16 @@ int main(int argc, char *argv[])
 	int module_address = -1;
 	int module_hw_revision = -1;
 	int assume_yes = 0;
+	// Cycle time for the following cyclic command, 0 selects its default.
+	unsigned long interval_us = 0;
+	// Output format of the following -r command.
+	int out_format = PI_FORMAT_TEXT;
+	// Query of a capture, run after all options are parsed.
+	struct pi_cap_query query = { 0 };
+	const char *query_vars[QUERY_MAX_VARS];
+	// Trigger rules of the following --scope command.
+	const char *triggers[SCOPE_MAX_TRIGGERS];
+	unsigned int ntriggers = 0;
 	char szVariableName[256];
 	char *pszTok, *progname;
 	int force_update = 0;
@@ -928,6 +1382,32 @@ int main(int argc, char *argv[])
 		[FORCE_LONG_ARG_INDEX] = { FORCE_LONG_ARG_NAME, no_argument, &force_update, 1 },
 		[ASSUME_YES_LONG_ARG_INDEX] = { ASSUME_YES_LONG_ARG_NAME, no_argument, &assume_yes, 1 },
 		[RESCUE_LONG_ARG_INDEX] = { RESCUE_LONG_ARG_NAME, required_argument, NULL, 0 },
+		[INTERVAL_LONG_ARG_INDEX] = { INTERVAL_LONG_ARG_NAME, required_argument, NULL, 0 },
+		[MONITOR_LONG_ARG_INDEX] = { MONITOR_LONG_ARG_NAME, required_argument, NULL, 0 },
+		[LOGIC_LONG_ARG_INDEX] = { LOGIC_LONG_ARG_NAME, required_argument, NULL, 0 },
+		[RT_LONG_ARG_INDEX] = { RT_LONG_ARG_NAME, required_argument, NULL, 0 },
+		[BRIDGE_PROFILE_LONG_ARG_INDEX] = { BRIDGE_PROFILE_LONG_ARG_NAME, required_argument, NULL, 0 },
+		[CONTENTION_LONG_ARG_INDEX] = { CONTENTION_LONG_ARG_NAME, required_argument, NULL, 0 },
+		[TORN_LONG_ARG_INDEX] = { TORN_LONG_ARG_NAME, required_argument, NULL, 0 },
+		[STATS_LONG_ARG_INDEX] = { STATS_LONG_ARG_NAME, no_argument, NULL, 0 },
+		[WATCH_LONG_ARG_INDEX] = { WATCH_LONG_ARG_NAME, required_argument, NULL, 0 },
+		[FORMAT_LONG_ARG_INDEX] = { FORMAT_LONG_ARG_NAME, required_argument, NULL, 0 },
+		[COLUMNAR_LONG_ARG_INDEX] = { COLUMNAR_LONG_ARG_NAME, required_argument, NULL, 0 },
+		[DECODE_LONG_ARG_INDEX] = { DECODE_LONG_ARG_NAME, required_argument, NULL, 0 },
+		[QUERY_LONG_ARG_INDEX] = { QUERY_LONG_ARG_NAME, required_argument, NULL, 0 },
+		[VAR_LONG_ARG_INDEX] = { VAR_LONG_ARG_NAME, required_argument, NULL, 0 },
+		[FROM_LONG_ARG_INDEX] = { FROM_LONG_ARG_NAME, required_argument, NULL, 0 },
+		[TO_LONG_ARG_INDEX] = { TO_LONG_ARG_NAME, required_argument, NULL, 0 },
+		[AGGREGATE_LONG_ARG_INDEX] = { AGGREGATE_LONG_ARG_NAME, no_argument, NULL, 0 },
+		[TRIGGER_LONG_ARG_INDEX] = { TRIGGER_LONG_ARG_NAME, required_argument, NULL, 0 },
+		[SCOPE_LONG_ARG_INDEX] = { SCOPE_LONG_ARG_NAME, required_argument, NULL, 0 },
+		[WINDOW_LONG_ARG_INDEX] = { WINDOW_LONG_ARG_NAME, required_argument, NULL, 0 },
+		[UNITS_LONG_ARG_INDEX] = { UNITS_LONG_ARG_NAME, required_argument, NULL, 0 },
+		[SCHEMA_LONG_ARG_INDEX] = { SCHEMA_LONG_ARG_NAME, required_argument, NULL, 0 },
+		[MODULES_LONG_ARG_INDEX] = { MODULES_LONG_ARG_NAME, required_argument, NULL, 0 },
+		[COUNTERS_LONG_ARG_INDEX] = { COUNTERS_LONG_ARG_NAME, required_argument, NULL, 0 },
+		[RO_COUNTERS_LONG_ARG_INDEX] = { RO_COUNTERS_LONG_ARG_NAME, optional_argument, NULL, 0 },
+		[TOP_LONG_ARG_INDEX] = { TOP_LONG_ARG_NAME, no_argument, NULL, 0 },
 		{0, 0, 0, 0}
 	};
 	int option_index = 0;
@@ -981,6 +1461,433 @@ int main(int argc, char *argv[])
 					break;
 				}
 
+				case INTERVAL_LONG_ARG_INDEX:
+				{
+					char *endptr = NULL;
+
+					interval_us = strtoul(optarg, &endptr, 10);
+					if (endptr == optarg || *endptr != '\0' ||
+					    interval_us == 0 || interval_us > UINT32_MAX) {
+						fprintf(stderr, "Invalid argument '%s' to option '%s'\n", optarg,
+							long_options[option_index].name);
+						return 1;
+					}
+					break;
+				}
+
+				case RT_LONG_ARG_INDEX:
+				{
+					int priority, cpu = -1;
+
+					rc = sscanf(optarg, "%d,%d", &priority, &cpu);
+					if (rc < 1 || priority < 1 || priority > 99) {
+						fprintf(stderr, "Invalid argument '%s' to option '%s'\n", optarg,
+							long_options[option_index].name);
+						fprintf(stderr, "Try '--rt priority[,cpu]' with a priority of 1 - 99\n");
+						return 1;
+					}
+					piCycleSetRealtime(priority, cpu);
+					break;
+				}
+
+				case STATS_LONG_ARG_INDEX:
+					if (enableStats() < 0)
+						return 1;
+					break;
+
+				case FORMAT_LONG_ARG_INDEX:
+					out_format = piFormatType(optarg);
+					if (out_format < 0) {
+						fprintf(stderr, "Invalid argument '%s' to option '%s'\n", optarg,
+							long_options[option_index].name);
+						return 1;
+					}
+					break;
+
+				case COLUMNAR_LONG_ARG_INDEX:
+				{
+					char *output = strchr(optarg, ',');
+
+					if (output == NULL || output == optarg || output[1] == '\0') {
+						fprintf(stderr, "Invalid argument '%s' to option '%s'\n", optarg,
+							long_options[option_index].name);
+						return 1;
+					}
+					*output++ = '\0';
+					rc = piColumnarConvert(optarg, output);
+					if (rc < 0) {
+						fprintf(stderr, "Failed to convert recording\n");
+						return 1;
+					}
+					return 0;
+				}
+
+				case DECODE_LONG_ARG_INDEX:
+					rc = piCapDecode(optarg, out_format);
+					if (rc < 0) {
+						fprintf(stderr, "Failed to decode capture\n");
+						return 1;
+					}
+					return 0;
+
+				case QUERY_LONG_ARG_INDEX:
+					query.path = optarg;
+					break;
+
+				case VAR_LONG_ARG_INDEX:
+				{
+					char *saveptr;
+
+					for (pszTok = strtok_r(optarg, ",", &saveptr); pszTok;
+					     pszTok = strtok_r(NULL, ",", &saveptr)) {
+						if (query.nvars == QUERY_MAX_VARS) {
+							fprintf(stderr, "Too many variables, at most %d\n",
+								QUERY_MAX_VARS);
+							return 1;
+						}
+						query_vars[query.nvars++] = pszTok;
+					}
+					query.vars = query_vars;
+					break;
+				}
+
+				case FROM_LONG_ARG_INDEX:
+					query.from = optarg;
+					break;
+
+				case TO_LONG_ARG_INDEX:
+					query.to = optarg;
+					break;
+
+				case AGGREGATE_LONG_ARG_INDEX:
+					query.aggregate = true;
+					break;
+
+				case TRIGGER_LONG_ARG_INDEX:
+					if (ntriggers == SCOPE_MAX_TRIGGERS) {
+						fprintf(stderr, "Too many triggers, at most %d\n",
+							SCOPE_MAX_TRIGGERS);
+						return 1;
+					}
+					triggers[ntriggers++] = optarg;
+					break;
+
+				case SCOPE_LONG_ARG_INDEX:
+				{
+					struct pi_scope_args args = { 0 };
+					const char *vars[64];
+					char *var, *saveptr = NULL;
+					int pos = 0;
+
+					rc = sscanf(optarg, "%u,%u,%n", &args.pre, &args.post, &pos);
+					if (rc < 2 || pos == 0) {
+						fprintf(stderr, "Wrong arguments for scope\n");
+						fprintf(stderr, "Try '--scope pre,post,variable[,variable...]'\n");
+						return 1;
+					}
+					if (ntriggers == 0) {
+						fprintf(stderr, "No trigger given, add --trigger <rule> before --scope\n");
+						return 1;
+					}
+					for (var = strtok_r(optarg + pos, ",", &saveptr); var;
+					     var = strtok_r(NULL, ",", &saveptr)) {
+						if (args.nvars == sizeof(vars) / sizeof(vars[0])) {
+							fprintf(stderr, "Too many variables for scope\n");
+							return 1;
+						}
+						vars[args.nvars++] = var;
+					}
+					if (args.nvars == 0) {
+						fprintf(stderr, "No variable given for scope\n");
+						return 1;
+					}
+					args.vars = vars;
+					args.triggers = triggers;
+					args.ntriggers = ntriggers;
+					args.period_us = interval_us ? interval_us : SCOPE_DEFAULT_INTERVAL_USEC;
+					args.once = !cyclic;
+					args.type = out_format;
+					rc = piScopeRun(&args);
+					if (rc < 0) {
+						fprintf(stderr, "Failed to run scope\n");
+						return 1;
+					}
+					return 0;
+				}
+
+				case WINDOW_LONG_ARG_INDEX:
+				{
+					struct pi_window_args args = { 0 };
+					const char *vars[64];
+					char *var, *saveptr = NULL;
+					int pos = 0;
+
+					rc = sscanf(optarg, "%u,%n", &args.window_ms, &pos);
+					if (rc < 1 || pos == 0 || args.window_ms == 0) {
+						fprintf(stderr, "Wrong arguments for window\n");
+						fprintf(stderr, "Try '--window ms,variable[,variable...]'\n");
+						return 1;
+					}
+					for (var = strtok_r(optarg + pos, ",", &saveptr); var;
+					     var = strtok_r(NULL, ",", &saveptr)) {
+						if (args.nvars == sizeof(vars) / sizeof(vars[0])) {
+							fprintf(stderr, "Too many variables for window\n");
+							return 1;
+						}
+						vars[args.nvars++] = var;
+					}
+					if (args.nvars == 0) {
+						fprintf(stderr, "No variable given for window\n");
+						return 1;
+					}
+					args.vars = vars;
+					args.period_us = interval_us ? interval_us : WINDOW_DEFAULT_INTERVAL_USEC;
+					args.once = !cyclic;
+					args.type = out_format;
+					rc = piWindowRun(&args);
+					if (rc < 0) {
+						fprintf(stderr, "Failed to compute window statistics\n");
+						return 1;
+					}
+					return 0;
+				}
+
+				case UNITS_LONG_ARG_INDEX:
+				{
+					struct pi_units_args args = {
+						.path = optarg,
+						.period_us = interval_us ? interval_us : READ_DEFAULT_INTERVAL_USEC,
+						.once = !cyclic,
+						.type = out_format,
+					};
+
+					rc = piUnitsRun(&args);
+					if (rc < 0) {
+						fprintf(stderr, "Failed to read scaled values\n");
+						return 1;
+					}
+					return 0;
+				}
+
+				case SCHEMA_LONG_ARG_INDEX:
+				{
+					struct pi_schema_args args = {
+						.path = optarg,
+						.period_us = interval_us ? interval_us : READ_DEFAULT_INTERVAL_USEC,
+						.once = !cyclic,
+						.type = out_format,
+					};
+					char *sep = strrchr(optarg, ','), *end;
+
+					if (sep) {
+						args.offset = strtoul(sep + 1, &end, 0);
+						if (sep[1] == '\0' || *end != '\0' || args.offset > UINT16_MAX) {
+							fprintf(stderr, "Wrong arguments for schema\n");
+							fprintf(stderr, "Try '--schema file[,offset]'\n");
+							return 1;
+						}
+						*sep = '\0';
+					}
+					rc = piSchemaRun(&args);
+					if (rc < 0) {
+						fprintf(stderr, "Failed to decode the region\n");
+						return 1;
+					}
+					return 0;
+				}
+
+				case MODULES_LONG_ARG_INDEX:
+				{
+					struct pi_module_args args = {
+						.period_us = interval_us ? interval_us : READ_DEFAULT_INTERVAL_USEC,
+						.once = !cyclic,
+						.type = out_format,
+					};
+					int addrs[REV_PI_DEV_CNT_MAX];
+					char *addr, *end, *saveptr = NULL;
+
+					if (strcmp(optarg, "all")) {
+						for (addr = strtok_r(optarg, ",", &saveptr); addr;
+						     addr = strtok_r(NULL, ",", &saveptr)) {
+							if (args.naddrs == REV_PI_DEV_CNT_MAX) {
+								fprintf(stderr, "Too many modules\n");
+								return 1;
+							}
+							addrs[args.naddrs] = strtol(addr, &end, 0);
+							if (*end != '\0' || addrs[args.naddrs] < 0 ||
+							    addrs[args.naddrs] > 255) {
+								fprintf(stderr, "Wrong arguments for modules\n");
+								fprintf(stderr, "Try '--modules address[,address...]' or '--modules all'\n");
+								return 1;
+							}
+							args.naddrs++;
+						}
+						if (args.naddrs == 0) {
+							fprintf(stderr, "Wrong arguments for modules\n");
+							return 1;
+						}
+					}
+					args.addrs = addrs;
+					rc = piModuleRun(&args);
+					if (rc < 0) {
+						fprintf(stderr, "Failed to decode the modules\n");
+						return 1;
+					}
+					return 0;
+				}
+
+				case COUNTERS_LONG_ARG_INDEX:
+				{
+					struct pi_counter_args args = {
+						.period_us = interval_us ? interval_us : COUNTERS_DEFAULT_INTERVAL_USEC,
+						.once = !cyclic,
+						.type = out_format,
+					};
+					int pos = 0;
+
+					rc = sscanf(optarg, "%u%n", &args.window_ms, &pos);
+					if (rc == 1 && !strcmp(optarg + pos, ",reset"))
+						args.reset = true;
+					else if (rc == 1 && optarg[pos] != '\0')
+						rc = 0;
+					if (rc != 1 || args.window_ms == 0) {
+						fprintf(stderr, "Wrong arguments for counters\n");
+						fprintf(stderr, "Try '--counters ms[,reset]'\n");
+						return 1;
+					}
+					rc = piCounterRun(&args);
+					if (rc < 0) {
+						fprintf(stderr, "Failed to sample the counters\n");
+						return 1;
+					}
+					return 0;
+				}
+
+				case RO_COUNTERS_LONG_ARG_INDEX:
+				{
+					struct pi_relay_args args = {
+						.state = optarg,
+						.type = out_format,
+					};
+
+					rc = piRelayRun(&args);
+					if (rc < 0) {
+						fprintf(stderr, "Failed to collect RO counters\n");
+						return 1;
+					}
+					return 0;
+				}
+
+				case TOP_LONG_ARG_INDEX:
+					rc = piTopRun(interval_us ? interval_us : TOP_DEFAULT_INTERVAL_USEC);
+					if (rc < 0) {
+						fprintf(stderr, "Failed to show the modules\n");
+						return 1;
+					}
+					return 0;
+
+				case WATCH_LONG_ARG_INDEX:
+					rc = piSubscribeWatch(optarg,
+							      interval_us ? interval_us : WATCH_DEFAULT_INTERVAL_USEC);
+					if (rc < 0) {
+						fprintf(stderr, "Failed to watch variables\n");
+						return 1;
+					}
+					return 0;
+
+				case MONITOR_LONG_ARG_INDEX:
+					rc = piMonitorRun(optarg,
+							  interval_us ? interval_us : MONITOR_DEFAULT_INTERVAL_USEC,
+							  cyclic);
+					if (rc < 0) {
+						fprintf(stderr, "Failed to monitor rules\n");
+						return 1;
+					}
+					return 0;
+
+				case BRIDGE_PROFILE_LONG_ARG_INDEX:
+				{
+					char *endptr = NULL;
+					unsigned long seconds;
+
+					seconds = strtoul(optarg, &endptr, 10);
+					if (endptr == optarg || *endptr != '\0' || seconds == 0) {
+						fprintf(stderr, "Invalid argument '%s' to option '%s'\n", optarg,
+							long_options[option_index].name);
+						return 1;
+					}
+					rc = piBridgeProfile(seconds, interval_us);
+					if (rc < 0) {
+						fprintf(stderr, "Failed to profile the piBridge cycle\n");
+						return 1;
+					}
+					return 0;
+				}
+
+				case CONTENTION_LONG_ARG_INDEX:
+				{
+					struct pi_contention_args args = { .seconds = 2 };
+					char flags[8] = "";
+
+					rc = sscanf(optarg, "%u,%u,%u,%u,%u,%7s", &args.readers,
+						    &args.writers, &args.offset, &args.length,
+						    &args.seconds, flags);
+					if (rc < 4 || args.seconds == 0 ||
+					    strspn(flags, "ob") != strlen(flags)) {
+						fprintf(stderr, "Wrong arguments for contention benchmark\n");
+						fprintf(stderr, "Try '--contention readers,writers,offset,length[,seconds[,flags]]'\n");
+						return 1;
+					}
+					args.overlap = strchr(flags, 'o') != NULL;
+					args.bits = strchr(flags, 'b') != NULL;
+					rc = piStressContention(&args);
+					if (rc < 0) {
+						fprintf(stderr, "Failed to run contention benchmark\n");
+						return 1;
+					}
+					return 0;
+				}
+
+				case TORN_LONG_ARG_INDEX:
+				{
+					struct pi_torn_args args = { 0 };
+					const char *vars[64];
+					char *var, *saveptr = NULL;
+					int pos = 0;
+
+					rc = sscanf(optarg, "%u,%u,%n", &args.readers, &args.seconds, &pos);
+					if (rc < 2 || pos == 0 || args.seconds == 0) {
+						fprintf(stderr, "Wrong arguments for torn read check\n");
+						fprintf(stderr, "Try '--torn readers,seconds,variable[,variable...]'\n");
+						return 1;
+					}
+					for (var = strtok_r(optarg + pos, ",", &saveptr); var;
+					     var = strtok_r(NULL, ",", &saveptr)) {
+						if (args.nvars == sizeof(vars) / sizeof(vars[0])) {
+							fprintf(stderr, "Too many variables for torn read check\n");
+							return 1;
+						}
+						vars[args.nvars++] = var;
+					}
+					args.vars = vars;
+					rc = piStressTorn(&args);
+					if (rc < 0) {
+						fprintf(stderr, "Failed to run torn read check\n");
+						return 1;
+					}
+					return rc;
+				}
+
+				case LOGIC_LONG_ARG_INDEX:
+					rc = piLogicRun(optarg,
+							interval_us ? interval_us : LOGIC_DEFAULT_INTERVAL_USEC,
+							cyclic);
+					if (rc < 0) {
+						fprintf(stderr, "Failed to execute logic rules\n");
+						return 1;
+					}
+					return 0;
+
 				default:
 					fprintf(stderr, "Invalid long option index %d\n", option_index);
 					return 1;
@@ -1019,10 +1926,20 @@ int main(int argc, char *argv[])
 			break;
 
 		case 'r':
+			if (out_format != PI_FORMAT_TEXT) {
+				rc = readFormatted(optarg, cyclic, out_format,
+						   interval_us ? interval_us : READ_DEFAULT_INTERVAL_USEC);
+				if (rc < 0) {
+					fprintf(stderr, "Failed to read data\n");
+					return 1;
+				}
+				return 0;
+			}
 			format = 'd';
 			rc = sscanf(optarg, "%d,%d,%c", &offset, &length, &format);
 			if (rc == 3) {
-				rc = readData(offset, length, cyclic, format, quiet);
+				rc = readData(offset, length, cyclic, format, quiet,
+					      interval_us ? interval_us : READ_DEFAULT_INTERVAL_USEC);
 				if (rc < 0) {
 					fprintf(stderr, "Failed to read data\n");
 					return 1;
@@ -1031,7 +1948,8 @@ int main(int argc, char *argv[])
 			}
 			rc = sscanf(optarg, "%d,%d", &offset, &length);
 			if (rc == 2) {
-				rc = readData(offset, length, cyclic, format, quiet);
+				rc = readData(offset, length, cyclic, format, quiet,
+					      interval_us ? interval_us : READ_DEFAULT_INTERVAL_USEC);
 				if (rc < 0) {
 					fprintf(stderr, "Failed to read data\n");
 					return 1;
@@ -1047,7 +1965,8 @@ int main(int argc, char *argv[])
 						format = *pszTok;
 					}
 				}
-				rc = readVariableValue(szVariableName, cyclic, format, quiet);
+				rc = readVariableValue(szVariableName, cyclic, format, quiet,
+						       interval_us ? interval_us : READ_DEFAULT_INTERVAL_USEC);
 				if (rc < 0) {
 					fprintf(stderr, "Failed to read variable value\n");
 					return 1;
@@ -1228,5 +2147,15 @@ int main(int argc, char *argv[])
 		}
 	}
 
+	if (query.path) {
+		query.type = out_format;
+		rc = piCapQuery(&query);
+		if (rc < 0) {
+			fprintf(stderr, "Failed to query capture\n");
+			return 1;
+		}
+	}
+
 	return 0;
 }
+#endif /* PITEST_NO_MAIN */
@@ -0,0 +1,421 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+/*!
+ * Project: piTest
+ * Demo source code for usage of piControl driver
+ *
+ * \file piTestBench.c
+ *
+ * \brief Microbenchmarks of the piControl interface and the piTest output
+ *
+ * Measures the cost per call of the piControlIf functions and of the
+ * formatting in readData() and readVariableValue() against the simulated
+ * piControl device, so the numbers do not depend on the hardware and can be
+ * compared between commits. The output of the formatting functions goes to
+ * /dev/null through a fully buffered stdout, the results are printed as CSV
+ * with one line per benchmark:
+ *
+ *   benchmark,iterations,ns_min,ns_median
+ *
+ * The formatting benchmarks include the read of the data, subtract the
+ * matching read benchmark to get the cost of the formatting alone. With
+ * io_uring support the batches are also run through an io_uring, which
+ * accesses the file of the simulated process image directly.
+ */
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "piControlIf.h"
+#include "piControlSim.h"
+#include "piImage.h"
+#include "piTest.h"
+#ifdef PITEST_IO_URING
+#include "piUring.h"
+#endif
+
+#define BENCH_DEFAULT_ROUNDS	5
+#define BENCH_DEFAULT_ROUND_MS	100
+#define BENCH_MAX_ROUNDS	100
+/* variables in the simulated config before the ones used by the benchmarks */
+#define BENCH_FILLER_VARS	128
+/* accesses per batch in the batch benchmarks */
+#define BENCH_BATCH		16
+
+/******************************************************************************/
+/*********************************  Types  ************************************/
+/******************************************************************************/
+
+struct bench {
+	const char *name;
+	void (*fn)(void);
+};
+
+/******************************************************************************/
+/******************************  Global Vars  *********************************/
+/******************************************************************************/
+
+static uint8_t buf[KB_PI_LEN];
+static struct pi_io batch[BENCH_BATCH];
+
+/******************************************************************************/
+/*******************************  Functions  **********************************/
+/******************************************************************************/
+
+static void bench_read_1(void)
+{
+	piControlRead(11, 1, buf);
+}
+
+static void bench_read_16(void)
+{
+	piControlRead(11, 16, buf);
+}
+
+static void bench_read_4096(void)
+{
+	piControlRead(0, KB_PI_LEN, buf);
+}
+
+static void bench_write_1(void)
+{
+	piControlWrite(81, 1, buf);
+}
+
+static void bench_write_16(void)
+{
+	piControlWrite(81, 16, buf);
+}
+
+static void bench_get_bit(void)
+{
+	SPIValue val = { .i16uAddress = 81, .i8uBit = 3 };
+
+	piControlGetBitValue(&val);
+}
+
+static void bench_set_bit(void)
+{
+	SPIValue val = { .i16uAddress = 81, .i8uBit = 3, .i8uValue = 1 };
+
+	piControlSetBitValue(&val);
+}
+
+static void bench_variable_info(void)
+{
+	SPIVariable var = { .strVarName = "Dword_1" };
+
+	piControlGetVariableInfo(&var);
+}
+
+static void bench_device_info(void)
+{
+	SDeviceInfo dev = { .i8uAddress = 31 };
+
+	piControlGetDeviceInfo(&dev);
+}
+
+static void bench_device_info_list(void)
+{
+	SDeviceInfo devs[REV_PI_DEV_CNT_MAX];
+
+	piControlGetDeviceInfoList(devs);
+}
+
+static void bench_batch(bool write)
+{
+	int i;
+
+	for (i = 0; i < BENCH_BATCH; i++) {
+		batch[i].offset = 11 + i * 16;
+		batch[i].length = 16;
+		batch[i].data = buf + i * 16;
+		batch[i].write = write;
+	}
+	piControlTransfer(batch, BENCH_BATCH);
+}
+
+static void bench_batch_read(void)
+{
+	bench_batch(false);
+}
+
+static void bench_batch_write(void)
+{
+	bench_batch(true);
+}
+
+static void bench_read_data_d(void)
+{
+	readData(11, 16, false, 'd', true, 0);
+}
+
+static void bench_read_data_h(void)
+{
+	readData(11, 16, false, 'h', true, 0);
+}
+
+static void bench_read_data_b(void)
+{
+	readData(11, 16, false, 'b', true, 0);
+}
+
+static void bench_read_data_s(void)
+{
+	readData(11, 16, false, 's', true, 0);
+}
+
+static void bench_read_variable_bit(void)
+{
+	readVariableValue("Bit_1", false, 'd', true, 0);
+}
+
+static void bench_read_variable_8(void)
+{
+	readVariableValue("Byte_1", false, 'd', true, 0);
+}
+
+static void bench_read_variable_16(void)
+{
+	readVariableValue("Word_1", false, 'd', true, 0);
+}
+
+static void bench_read_variable_32(void)
+{
+	readVariableValue("Dword_1", false, 'd', true, 0);
+}
+
+static void bench_read_variable_32_h(void)
+{
+	readVariableValue("Dword_1", false, 'h', true, 0);
+}
+
+static void bench_read_variable_32_b(void)
+{
+	readVariableValue("Dword_1", false, 'b', true, 0);
+}
+
+static void bench_read_variable_32_verbose(void)
+{
+	readVariableValue("Dword_1", false, 'd', false, 0);
+}
+
+static const struct bench benches[] = {
+	{ "read_1", bench_read_1 },
+	{ "read_16", bench_read_16 },
+	{ "read_4096", bench_read_4096 },
+	{ "write_1", bench_write_1 },
+	{ "write_16", bench_write_16 },
+	{ "get_bit", bench_get_bit },
+	{ "set_bit", bench_set_bit },
+	{ "variable_info", bench_variable_info },
+	{ "device_info", bench_device_info },
+	{ "device_info_list", bench_device_info_list },
+	{ "batch_read_16x16", bench_batch_read },
+	{ "batch_write_16x16", bench_batch_write },
+	{ "read_data_d_16", bench_read_data_d },
+	{ "read_data_h_16", bench_read_data_h },
+	{ "read_data_b_16", bench_read_data_b },
+	{ "read_data_s_16", bench_read_data_s },
+	{ "read_variable_bit", bench_read_variable_bit },
+	{ "read_variable_8", bench_read_variable_8 },
+	{ "read_variable_16", bench_read_variable_16 },
+	{ "read_variable_32", bench_read_variable_32 },
+	{ "read_variable_32_h", bench_read_variable_32_h },
+	{ "read_variable_32_b", bench_read_variable_32_b },
+	{ "read_variable_32_verbose", bench_read_variable_32_verbose },
+};
+
+#ifdef PITEST_IO_URING
+/* run with an io_uring with the benchmark buffer registered */
+static const struct bench uring_benches[] = {
+	{ "uring_batch_read_16x16", bench_batch_read },
+	{ "uring_batch_write_16x16", bench_batch_write },
+};
+#endif
+
+/***********************************************************************************/
+/*!
+ * @brief Write the config of the simulated device used by the benchmarks
+ *
+ * A RevPi Core and a DIO module, with variables in front of the benchmarked
+ * ones like in a populated configuration.
+ *
+ * @param[out]  path	name of the created config file
+ *
+ * @return 0 on success, < 0 on error
+ *
+ ************************************************************************************/
+static int write_config(char *path)
+{
+	FILE *fp;
+	int fd, i;
+
+	fd = mkstemp(path);
+	if (fd < 0) {
+		fprintf(stderr, "Cannot create %s: %s\n", path, strerror(errno));
+		return -errno;
+	}
+	fp = fdopen(fd, "w");
+	if (!fp) {
+		close(fd);
+		return -ENOMEM;
+	}
+
+	fprintf(fp, "device 0 %d 0 11 11 0\n", KUNBUS_FW_DESCR_TYP_PI_CORE);
+	fprintf(fp, "device 31 %d 11 70 81 18\n", KUNBUS_FW_DESCR_TYP_PI_DIO_14);
+	for (i = 0; i < BENCH_FILLER_VARS; i++)
+		fprintf(fp, "var Var_%d %d 0 8\n", i, 100 + i);
+	fprintf(fp, "var Bit_1 81 3 1\n");
+	fprintf(fp, "var Byte_1 11 0 8\n");
+	fprintf(fp, "var Word_1 12 0 16\n");
+	fprintf(fp, "var Dword_1 17 0 32\n");
+
+	if (fclose(fp) < 0)
+		return -errno;
+
+	return 0;
+}
+
+static int compare_double(const void *a, const void *b)
+{
+	double da = *(const double *)a, db = *(const double *)b;
+
+	return da < db ? -1 : da > db;
+}
+
+static uint64_t run(void (*fn)(void), uint64_t iterations)
+{
+	uint64_t start = piImageTimestamp();
+
+	while (iterations--)
+		fn();
+
+	return piImageTimestamp() - start;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Run one benchmark
+ *
+ * The number of iterations is calibrated so that a round takes about
+ * round_ms, the minimum and the median over the rounds are reported.
+ *
+ ************************************************************************************/
+static void run_bench(FILE *out, const struct bench *b, unsigned int rounds,
+		      unsigned int round_ms)
+{
+	double ns[BENCH_MAX_ROUNDS];
+	uint64_t iterations = 1, elapsed;
+	unsigned int i;
+
+	/* calibrate on about a tenth of a round, this also warms up caches */
+	while ((elapsed = run(b->fn, iterations)) < round_ms * 100000ULL)
+		iterations *= 2;
+	iterations = iterations * round_ms * 1000000ULL / elapsed;
+	if (iterations == 0)
+		iterations = 1;
+
+	for (i = 0; i < rounds; i++)
+		ns[i] = (double)run(b->fn, iterations) / iterations;
+	fflush(stdout);
+
+	qsort(ns, rounds, sizeof(*ns), compare_double);
+	fprintf(out, "%s,%llu,%.1f,%.1f\n", b->name, (unsigned long long)iterations,
+		ns[0], ns[rounds / 2]);
+	fflush(out);
+}
+
+static void usage(const char *programname)
+{
+	fprintf(stderr, "Usage: %s [-r <rounds>] [-t <ms per round>] [-f <filter>]\n",
+		programname);
+	fprintf(stderr, "  -r <rounds>        rounds per benchmark (default %d, max %d)\n",
+		BENCH_DEFAULT_ROUNDS, BENCH_MAX_ROUNDS);
+	fprintf(stderr, "  -t <ms>            duration of a round (default %d)\n",
+		BENCH_DEFAULT_ROUND_MS);
+	fprintf(stderr, "  -f <filter>        run only benchmarks whose name contains <filter>\n");
+}
+
+int main(int argc, char *argv[])
+{
+	char config[] = "/tmp/piTestBench.XXXXXX";
+	unsigned int rounds = BENCH_DEFAULT_ROUNDS;
+	unsigned int round_ms = BENCH_DEFAULT_ROUND_MS;
+	const char *filter = NULL;
+	FILE *out;
+	size_t i;
+	int null, c, rc;
+
+	while ((c = getopt(argc, argv, "r:t:f:h")) != -1) {
+		switch (c) {
+		case 'r':
+			rounds = strtoul(optarg, NULL, 0);
+			break;
+		case 't':
+			round_ms = strtoul(optarg, NULL, 0);
+			break;
+		case 'f':
+			filter = optarg;
+			break;
+		default:
+			usage(argv[0]);
+			return c == 'h' ? 0 : 1;
+		}
+	}
+	if (rounds == 0 || rounds > BENCH_MAX_ROUNDS || round_ms == 0) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	rc = write_config(config);
+	if (rc < 0)
+		return 1;
+	setenv(PICONTROL_SIM_ENV, config, 1);
+	rc = piControlOpen();
+	unlink(config);
+	if (rc < 0)
+		return 1;
+
+	/* results go to the original stdout, the benchmarked output to /dev/null */
+	out = fdopen(dup(STDOUT_FILENO), "w");
+	null = open("/dev/null", O_WRONLY);
+	if (!out || null < 0 || dup2(null, STDOUT_FILENO) < 0) {
+		fprintf(stderr, "Cannot redirect stdout: %s\n", strerror(errno));
+		return 1;
+	}
+	close(null);
+	setvbuf(stdout, NULL, _IOFBF, BUFSIZ);
+
+	fprintf(out, "benchmark,iterations,ns_min,ns_median\n");
+	for (i = 0; i < sizeof(benches) / sizeof(benches[0]); i++) {
+		if (filter && !strstr(benches[i].name, filter))
+			continue;
+		run_bench(out, &benches[i], rounds, round_ms);
+	}
+
+#ifdef PITEST_IO_URING
+	if (piUringInit(2 * BENCH_BATCH, buf, sizeof(buf)) == 0) {
+		for (i = 0; i < sizeof(uring_benches) / sizeof(uring_benches[0]); i++) {
+			if (filter && !strstr(uring_benches[i].name, filter))
+				continue;
+			run_bench(out, &uring_benches[i], rounds, round_ms);
+		}
+		piUringExit();
+	}
+#endif
+
+	piControlClose();
+	fclose(out);
+	return 0;
+}
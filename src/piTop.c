@@ -0,0 +1,321 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+/*!
+ * Project: piTest
+ * Demo source code for usage of piControl driver
+ *
+ * \file piTop.c
+ *
+ * \brief Live view of all modules
+ *
+ * All modules of the device list are decoded by their module type, see
+ * piModule.c, and shown in a full screen view. The screen is drawn once;
+ * afterwards the formatted values are compared with the ones on the screen
+ * and only the changed cells are redrawn with cursor addressed updates,
+ * written with a single write per frame. This keeps the output small
+ * enough for slow remote connections.
+ */
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "piCycle.h"
+#include "piModule.h"
+#include "piTest.h"
+#include "piTop.h"
+
+/******************************************************************************/
+/*********************************  Types  ************************************/
+/******************************************************************************/
+
+#define TOP_NAME_WIDTH	20
+#define TOP_VALUE_WIDTH	11
+#define TOP_CELL_WIDTH	(TOP_NAME_WIDTH + 1 + TOP_VALUE_WIDTH + 2)
+#define TOP_VALUE_LEN	(TOP_VALUE_WIDTH + 1)
+
+/* a field on the screen, row 0 if it does not fit */
+struct top_cell {
+	uint16_t row;
+	uint16_t col;
+	char value[TOP_VALUE_LEN];	/* text currently on the screen */
+};
+
+struct top_buf {
+	char *data;
+	size_t len;
+	size_t size;
+};
+
+struct top {
+	struct pi_modules mods;
+	struct top_cell *cells;
+	struct pi_schema_value *values;
+	uint8_t *image;
+	struct top_buf out;
+	unsigned short rows;		/* size of the terminal */
+	unsigned short cols;
+	unsigned int hidden;		/* fields not fitting on the screen */
+	uint32_t period_us;
+};
+
+/******************************************************************************/
+/*******************************  Functions  **********************************/
+/******************************************************************************/
+
+static void __attribute__((format(printf, 2, 3)))
+buf_printf(struct top_buf *buf, const char *fmt, ...)
+{
+	va_list ap;
+	size_t size;
+	char *data;
+	int n;
+
+	va_start(ap, fmt);
+	n = vsnprintf(buf->data + buf->len, buf->size - buf->len, fmt, ap);
+	va_end(ap);
+	if (n < 0)
+		return;
+
+	if (buf->len + n >= buf->size) {
+		size = buf->size * 2 > buf->len + n + 1 ? buf->size * 2 : buf->len + n + 1;
+		data = realloc(buf->data, size);
+		if (!data)
+			return;
+		buf->data = data;
+		buf->size = size;
+
+		va_start(ap, fmt);
+		vsnprintf(buf->data + buf->len, buf->size - buf->len, fmt, ap);
+		va_end(ap);
+	}
+	buf->len += n;
+}
+
+/* write the frame with a single write */
+static void buf_flush(struct top_buf *buf)
+{
+	size_t done = 0;
+	ssize_t n;
+
+	while (done < buf->len) {
+		n = write(STDOUT_FILENO, buf->data + done, buf->len - done);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			break;
+		done += n;
+	}
+	buf->len = 0;
+}
+
+static void terminal_size(unsigned short *rows, unsigned short *cols)
+{
+	struct winsize ws;
+
+	if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_row && ws.ws_col) {
+		*rows = ws.ws_row;
+		*cols = ws.ws_col;
+	} else {
+		*rows = 24;
+		*cols = 80;
+	}
+}
+
+/* name of a field without the address of the module */
+static const char *field_name(const struct pi_schema_field *field)
+{
+	const char *dot = strchr(field->name, '.');
+
+	return dot ? dot + 1 : field->name;
+}
+
+/* assign the screen positions, row 1 is the status line */
+static void layout(struct top *top)
+{
+	const struct pi_module *mod;
+	unsigned int ncols, m, i, row = 3;
+
+	ncols = top->cols / TOP_CELL_WIDTH;
+	if (ncols == 0)
+		ncols = 1;
+
+	top->hidden = 0;
+	for (m = 0; m < top->mods.count; m++) {
+		mod = &top->mods.modules[m];
+		for (i = 0; i < mod->count; i++) {
+			struct top_cell *cell = &top->cells[mod->first + i];
+
+			cell->row = row + 1 + i / ncols;
+			cell->col = 1 + (i % ncols) * TOP_CELL_WIDTH;
+			cell->value[0] = '\0';
+			if (cell->row >= top->rows) {
+				cell->row = 0;
+				top->hidden++;
+			}
+		}
+		row += 1 + (mod->count + ncols - 1) / ncols + 1;
+	}
+}
+
+static void draw_status(struct top *top)
+{
+	char timestr[32];
+	struct tm tm;
+	time_t now;
+
+	now = time(NULL);
+	localtime_r(&now, &tm);
+	strftime(timestr, sizeof(timestr), "%H:%M:%S", &tm);
+
+	buf_printf(&top->out, "\033[1;1H\033[7mpiTest top  %s  %u modules  every %u ms",
+		   timestr, top->mods.count, top->period_us / 1000);
+	if (top->hidden)
+		buf_printf(&top->out, "  %u fields not shown", top->hidden);
+	buf_printf(&top->out, "\033[K\033[0m");
+}
+
+/* clear the screen and draw the headers and the names of the fields */
+static void draw_screen(struct top *top)
+{
+	const struct pi_module *mod;
+	const struct top_cell *cell;
+	unsigned int m, i;
+	uint16_t type;
+
+	terminal_size(&top->rows, &top->cols);
+	layout(top);
+
+	buf_printf(&top->out, "\033[?25l\033[2J");
+	for (m = 0; m < top->mods.count; m++) {
+		mod = &top->mods.modules[m];
+		cell = &top->cells[mod->first];
+		type = mod->dev->i16uModuleType;
+		if (!mod->dev->i8uActive)
+			type &= PICONTROL_NOT_CONNECTED_MASK;
+
+		if (mod->count && cell->row)
+			buf_printf(&top->out, "\033[%u;1H\033[1mAddress %u: %s\033[0m", cell->row - 1,
+				   mod->dev->i8uAddress, getModuleName(type));
+		for (i = 0; i < mod->count; i++, cell++) {
+			if (!cell->row)
+				continue;
+			buf_printf(&top->out, "\033[%u;%uH%-*.*s", cell->row, cell->col, TOP_NAME_WIDTH,
+				   TOP_NAME_WIDTH, field_name(&top->mods.schema.fields[mod->first + i]));
+		}
+	}
+}
+
+/* redraw the values differing from the screen */
+static void draw_values(struct top *top)
+{
+	char value[TOP_VALUE_LEN];
+	struct top_cell *cell;
+	unsigned int i;
+
+	for (i = 0; i < top->mods.schema.count; i++) {
+		cell = &top->cells[i];
+		if (!cell->row)
+			continue;
+
+		piSchemaFormat(&top->mods.schema.fields[i], &top->values[i], value, sizeof(value));
+		if (cell->value[0] && !strcmp(value, cell->value))
+			continue;
+
+		buf_printf(&top->out, "\033[%u;%uH%*s", cell->row, cell->col + TOP_NAME_WIDTH + 1,
+			   TOP_VALUE_WIDTH, value);
+		memcpy(cell->value, value, sizeof(value));
+	}
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Show all modules in a live full screen view
+ *
+ * The modules are read every period and the changed values are redrawn.
+ * The view is redrawn completely when the size of the terminal changes.
+ * Runs until interrupted.
+ *
+ * @param[in]   period_us	refresh period
+ *
+ * @return 0 on success, < 0 on error
+ *
+ ************************************************************************************/
+int piTopRun(uint32_t period_us)
+{
+	struct top top = { .period_us = period_us };
+	unsigned short rows, cols;
+	struct pi_cycle cycle;
+	time_t last = 0, now;
+	int rc;
+
+	if (!isatty(STDOUT_FILENO)) {
+		fprintf(stderr, "--top needs a terminal\n");
+		return -ENOTTY;
+	}
+
+	rc = piModulesInit(&top.mods, NULL, 0);
+	if (rc < 0)
+		return rc;
+
+	top.cells = calloc(top.mods.schema.count, sizeof(*top.cells));
+	top.values = calloc(top.mods.schema.count, sizeof(*top.values));
+	top.image = calloc(1, top.mods.span.length + PI_SCHEMA_PADDING);
+	top.out.size = 4096 + top.mods.schema.count * 32;
+	top.out.data = malloc(top.out.size);
+	if (!top.cells || !top.values || !top.image || !top.out.data) {
+		fprintf(stderr, "Not enough memory\n");
+		rc = -ENOMEM;
+		goto out;
+	}
+
+	rc = piCycleStart(&cycle, period_us);
+	if (rc < 0)
+		goto out;
+
+	draw_screen(&top);
+	do {
+		terminal_size(&rows, &cols);
+		if (rows != top.rows || cols != top.cols) {
+			draw_screen(&top);
+			last = 0;
+		}
+
+		rc = piModulesRead(&top.mods, top.image);
+		if (rc < 0)
+			break;
+		piSchemaDecode(&top.mods.schema, top.image, top.values);
+
+		draw_values(&top);
+		now = time(NULL);
+		if (now != last) {
+			draw_status(&top);
+			last = now;
+		}
+		buf_flush(&top.out);
+	} while (piCycleWait(&cycle));
+
+	/* leave the cursor below the view */
+	buf_printf(&top.out, "\033[%u;1H\033[?25h\n", top.rows);
+	buf_flush(&top.out);
+	piCycleFinish(&cycle);
+
+out:
+	free(top.out.data);
+	free(top.image);
+	free(top.values);
+	free(top.cells);
+	piModulesFree(&top.mods);
+	return rc;
+}
@@ -0,0 +1,348 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+/*!
+ * Project: piTest
+ * Demo source code for usage of piControl driver
+ *
+ * \file piUnits.c
+ *
+ * \brief Conversion of raw values into engineering units
+ *
+ * A scaling table assigns a gain, an offset and a unit to variables, e.g. to
+ * the channels of analog modules. The table is resolved once; afterwards a
+ * single read of the span of all channels is converted by extracting all raw
+ * values and then scaling all of them, both loops without branches per
+ * value.
+ */
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "piControlIf.h"
+#include "piCycle.h"
+#include "piFormat.h"
+#include "piSampler.h"
+#include "piUnits.h"
+
+/******************************************************************************/
+/*********************************  Types  ************************************/
+/******************************************************************************/
+
+struct units_output {
+	const struct pi_units *units;
+	struct pi_schema_value *raw;
+	double *values;
+	int64_t wall_offset;
+	struct pi_format *fmt;
+};
+
+/******************************************************************************/
+/*******************************  Functions  **********************************/
+/******************************************************************************/
+
+static int units_add(struct pi_units *units, const char *args)
+{
+	char spec[64], unit[PI_UNITS_NAME_LEN] = "";
+	unsigned int count = units->table.count;
+	double gain, offset;
+	void *p;
+	int rc;
+
+	if (sscanf(args, "%63s %lf %lf %15s", spec, &gain, &offset, unit) < 3)
+		return -EINVAL;
+
+	rc = piVarTableAdd(&units->table, spec);
+	if (rc < 0)
+		return rc;
+	if ((unsigned int)rc < count)
+		return -EEXIST;
+
+	p = realloc(units->gain, (count + 1) * sizeof(*units->gain));
+	if (!p)
+		return -ENOMEM;
+	units->gain = p;
+	p = realloc(units->offset, (count + 1) * sizeof(*units->offset));
+	if (!p)
+		return -ENOMEM;
+	units->offset = p;
+	p = realloc(units->unit, (count + 1) * sizeof(*units->unit));
+	if (!p)
+		return -ENOMEM;
+	units->unit = p;
+
+	units->gain[count] = gain;
+	units->offset[count] = offset;
+	memcpy(units->unit[count], unit, sizeof(unit));
+
+	return 0;
+}
+
+/* compile the channels into a schema of the span, decoding their raw values */
+static int units_compile(struct pi_units *units)
+{
+	unsigned int i, count = units->table.count;
+	int rc;
+
+	piSpanInit(&units->span);
+	for (i = 0; i < count; i++)
+		piSpanAdd(&units->span, units->table.vars[i].offset,
+			  piImageVarBytes(&units->table.vars[i]));
+
+	for (i = 0; i < count; i++) {
+		rc = piSchemaAddVar(&units->schema, &units->table.vars[i], units->span.offset);
+		if (rc < 0)
+			return rc;
+	}
+
+	return 0;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Load a scaling table
+ *
+ * Every line of the file holds a variable as accepted by piImageResolve(),
+ * a gain, an offset and optionally a unit, separated by blanks. The value
+ * in engineering units is raw * gain + offset. Everything after a '#' is a
+ * comment.
+ *
+ * @param[out]  units	table, to be freed with piUnitsFree()
+ * @param[in]   path	path of the file
+ *
+ * @return 0 on success, < 0 on error
+ *
+ ************************************************************************************/
+int piUnitsLoad(struct pi_units *units, const char *path)
+{
+	char line[256], *p;
+	unsigned int lineno = 0;
+	FILE *fp;
+	int rc = 0;
+
+	memset(units, 0, sizeof(*units));
+
+	fp = fopen(path, "r");
+	if (!fp) {
+		rc = -errno;
+		fprintf(stderr, "Cannot open scaling table '%s': %s\n", path, strerror(-rc));
+		return rc;
+	}
+
+	while (rc == 0 && fgets(line, sizeof(line), fp)) {
+		lineno++;
+		p = strchr(line, '#');
+		if (p)
+			*p = '\0';
+		p = line + strspn(line, " \t\n");
+		if (!*p)
+			continue;
+
+		rc = units_add(units, p);
+		if (rc < 0)
+			fprintf(stderr, "%s:%u: invalid entry: %s\n", path, lineno, strerror(-rc));
+	}
+	fclose(fp);
+
+	if (rc == 0 && units->table.count == 0) {
+		fprintf(stderr, "No variables in scaling table '%s'\n", path);
+		rc = -EINVAL;
+	}
+	if (rc == 0) {
+		rc = units_compile(units);
+		if (rc < 0)
+			fprintf(stderr, "Cannot compile scaling table '%s': %s\n", path,
+				strerror(-rc));
+	}
+	if (rc < 0)
+		piUnitsFree(units);
+
+	return rc;
+}
+
+void piUnitsFree(struct pi_units *units)
+{
+	piVarTableFree(&units->table);
+	piSchemaFree(&units->schema);
+	free(units->gain);
+	free(units->offset);
+	free(units->unit);
+	memset(units, 0, sizeof(*units));
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Convert a read of the span of a scaling table
+ *
+ * The raw values of all channels are decoded with piSchemaDecode() and then
+ * scaled in a separate loop.
+ *
+ * @param[in]   units	scaling table
+ * @param[in]   image	read of units->span followed by PI_SCHEMA_PADDING bytes
+ * @param[out]  raw	one raw value per channel
+ * @param[out]  values	one value per channel
+ *
+ ************************************************************************************/
+void piUnitsConvert(const struct pi_units *units, const uint8_t *image,
+		    struct pi_schema_value *raw, double *values)
+{
+	unsigned int i, count = units->table.count;
+
+	piSchemaDecode(&units->schema, image, raw);
+
+	for (i = 0; i < count; i++)
+		values[i] = raw[i].i * units->gain[i] + units->offset[i];
+}
+
+static void print_header(const struct pi_units *units, struct pi_format *fmt)
+{
+	char name[sizeof(units->table.vars->name) + PI_UNITS_NAME_LEN + 2];
+	unsigned int i;
+
+	if (fmt->type != PI_FORMAT_CSV)
+		return;
+
+	piFormatName(fmt, "ts_ns");
+	for (i = 0; i < units->table.count; i++) {
+		if (units->unit[i][0])
+			snprintf(name, sizeof(name), "%s[%s]", units->table.vars[i].name,
+				 units->unit[i]);
+		else
+			snprintf(name, sizeof(name), "%s", units->table.vars[i].name);
+		piFormatName(fmt, name);
+	}
+	piFormatEnd(fmt);
+}
+
+/* print the values of a sample, timestamp is the wall clock time in ns */
+static void print_values(const struct pi_units *units, struct pi_format *fmt, uint64_t timestamp,
+			 const double *values)
+{
+	unsigned int i;
+
+	if (fmt->type == PI_FORMAT_TEXT) {
+		piFormatPrintf(fmt, "%10" PRIu64 ".%06" PRIu64, timestamp / 1000000000,
+			       (timestamp % 1000000000) / 1000);
+		for (i = 0; i < units->table.count; i++)
+			piFormatPrintf(fmt, "  %s %.10g%s%s", units->table.vars[i].name, values[i],
+				       units->unit[i][0] ? " " : "", units->unit[i]);
+		piFormatPrintf(fmt, "\n");
+		return;
+	}
+
+	piFormatKey(fmt, "ts_ns");
+	piFormatUint(fmt, timestamp);
+	for (i = 0; i < units->table.count; i++) {
+		piFormatKey(fmt, units->table.vars[i].name);
+		piFormatDouble(fmt, "%.10g", values[i]);
+	}
+	piFormatEnd(fmt);
+}
+
+static void units_output(void *ctx, uint64_t timestamp, const uint8_t *sample)
+{
+	struct units_output *out = ctx;
+
+	piUnitsConvert(out->units, sample, out->raw, out->values);
+	print_values(out->units, out->fmt, timestamp + out->wall_offset, out->values);
+}
+
+static void units_flush(void *ctx)
+{
+	struct units_output *out = ctx;
+
+	piFormatFlush(out->fmt);
+}
+
+/* read the span every period, converted and printed by an output thread */
+static int units_cyclic(struct units_output *out, uint32_t period_us)
+{
+	const struct pi_span *span = &out->units->span;
+	struct pi_sampler sampler = {
+		.output = units_output,
+		.flush = units_flush,
+		.ctx = out,
+	};
+	int rc;
+
+	rc = piSamplerStart(&sampler, 0, span->length + PI_SCHEMA_PADDING);
+	if (rc < 0)
+		return rc;
+	rc = piSamplerRead(&sampler, span->offset, span->length, period_us);
+	piSamplerStop(&sampler);
+
+	return rc;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Print the variables of a scaling table in engineering units
+ *
+ * All variables are read with one read per period.
+ *
+ * @param[in]   args	parameters of the output
+ *
+ * @return 0 on success, < 0 on error
+ *
+ ************************************************************************************/
+int piUnitsRun(const struct pi_units_args *args)
+{
+	struct units_output out = { 0 };
+	struct pi_units units;
+	uint8_t *image = NULL;
+	int rc;
+
+	rc = piFormatTextual(args->type);
+	if (rc < 0)
+		return rc;
+
+	rc = piUnitsLoad(&units, args->path);
+	if (rc < 0)
+		return rc;
+
+	out.units = &units;
+	out.raw = malloc(units.table.count * sizeof(*out.raw));
+	out.values = malloc(units.table.count * sizeof(*out.values));
+	out.fmt = malloc(sizeof(*out.fmt));
+	image = calloc(1, units.span.length + PI_SCHEMA_PADDING);
+	if (!out.raw || !out.values || !out.fmt || !image) {
+		fprintf(stderr, "Not enough memory\n");
+		rc = -ENOMEM;
+		goto out;
+	}
+
+	piFormatInit(out.fmt, args->type, STDOUT_FILENO, NULL, 0);
+	print_header(&units, out.fmt);
+	out.wall_offset = piImageWallclock() - piImageTimestamp();
+
+	if (!args->once) {
+		rc = units_cyclic(&out, args->period_us);
+	} else {
+		rc = piControlRead(units.span.offset, units.span.length, image);
+		if (rc >= 0) {
+			piUnitsConvert(&units, image, out.raw, out.values);
+			print_values(&units, out.fmt, piImageWallclock(), out.values);
+			rc = 0;
+		}
+	}
+
+	if (piFormatFinish(out.fmt) < 0 && rc == 0)
+		rc = out.fmt->error;
+
+out:
+	free(out.fmt);
+	free(image);
+	free(out.values);
+	free(out.raw);
+	piUnitsFree(&units);
+	return rc;
+}
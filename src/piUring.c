@@ -0,0 +1,231 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+/*!
+ * Project: piTest
+ * Demo source code for usage of piControl driver
+ *
+ * \file piUring.c
+ *
+ * \brief Asynchronous process image I/O with io_uring
+ *
+ * Reads and writes of the process image are queued to an io_uring and
+ * completed asynchronously, so that a process can keep many accesses in
+ * flight and do other work meanwhile, without one system call per access.
+ * The piControl handle is registered with the ring, and optionally a buffer
+ * region: accesses whose data lies within it use the fixed buffer
+ * operations, which save mapping the user pages for every access.
+ */
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <errno.h>
+#include <liburing.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/uio.h>
+
+#include "piControlIf.h"
+#include "piUring.h"
+
+/******************************************************************************/
+/******************************  Global Vars  *********************************/
+/******************************************************************************/
+
+static struct {
+	struct io_uring ring;
+	bool active;
+	uint8_t *buffer;
+	size_t size;
+} uring;
+
+/******************************************************************************/
+/*******************************  Functions  **********************************/
+/******************************************************************************/
+
+/***********************************************************************************/
+/*!
+ * @brief Set up the io_uring
+ *
+ * After this piControlTransfer() submits its accesses through the ring.
+ *
+ * @param[in]   entries	size of the submission queue
+ * @param[in]   buffer	region to register for fixed buffer accesses, may be NULL
+ * @param[in]   size	size of the region
+ *
+ * @return 0 on success, < 0 on error
+ *
+ ************************************************************************************/
+int piUringInit(unsigned int entries, void *buffer, size_t size)
+{
+	struct iovec iov;
+	int rc;
+
+	if (uring.active)
+		return -EBUSY;
+
+	rc = piControlOpen();
+	if (rc < 0)
+		return rc;
+
+	rc = io_uring_queue_init(entries, &uring.ring, 0);
+	if (rc < 0) {
+		fprintf(stderr, "Failed to set up io_uring: %s\n", strerror(-rc));
+		return rc;
+	}
+
+	rc = io_uring_register_files(&uring.ring, &PiControlHandle_g, 1);
+	if (rc < 0) {
+		fprintf(stderr, "Failed to register piControl handle: %s\n", strerror(-rc));
+		goto err;
+	}
+
+	if (buffer && size) {
+		iov.iov_base = buffer;
+		iov.iov_len = size;
+		rc = io_uring_register_buffers(&uring.ring, &iov, 1);
+		if (rc < 0) {
+			fprintf(stderr, "Failed to register buffers: %s\n", strerror(-rc));
+			goto err;
+		}
+		uring.buffer = buffer;
+		uring.size = size;
+	}
+
+	uring.active = true;
+	return 0;
+
+err:
+	io_uring_queue_exit(&uring.ring);
+	return rc;
+}
+
+void piUringExit(void)
+{
+	if (!uring.active)
+		return;
+
+	io_uring_queue_exit(&uring.ring);
+	uring.active = false;
+	uring.buffer = NULL;
+	uring.size = 0;
+}
+
+bool piUringActive(void)
+{
+	return uring.active;
+}
+
+static bool registered(const struct pi_io *io)
+{
+	return uring.buffer && io->data >= uring.buffer &&
+	       io->data + io->length <= uring.buffer + uring.size;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Submit accesses
+ *
+ * Queues as many of the accesses as there is room for in the submission
+ * queue and submits them with one system call. The accesses are not ordered
+ * among each other, their data must stay valid until they are reaped.
+ *
+ * If the kernel took fewer entries than were queued, the rest stays queued.
+ * The next call must then start with the first access not submitted; these
+ * are not queued a second time.
+ *
+ * @param[in]   ios	accesses
+ * @param[in]   n	number of accesses
+ *
+ * @return number of submitted accesses, 0 if the queue is full, < 0 on error
+ *
+ ************************************************************************************/
+int piUringSubmit(struct pi_io *ios, unsigned int n)
+{
+	struct io_uring_sqe *sqe;
+	struct pi_io *io;
+	unsigned int i;
+	int rc;
+
+	/* entries left over from a short submit are the first accesses */
+	i = io_uring_sq_ready(&uring.ring);
+	if (i > n)
+		return -EINVAL;
+
+	for (; i < n; i++) {
+		sqe = io_uring_get_sqe(&uring.ring);
+		if (!sqe)
+			break;
+
+		io = &ios[i];
+		if (io->write && registered(io))
+			io_uring_prep_write_fixed(sqe, 0, io->data, io->length, io->offset, 0);
+		else if (io->write)
+			io_uring_prep_write(sqe, 0, io->data, io->length, io->offset);
+		else if (registered(io))
+			io_uring_prep_read_fixed(sqe, 0, io->data, io->length, io->offset, 0);
+		else
+			io_uring_prep_read(sqe, 0, io->data, io->length, io->offset);
+		sqe->flags |= IOSQE_FIXED_FILE;
+		io_uring_sqe_set_data(sqe, io);
+	}
+
+	if (i == 0)
+		return 0;
+
+	rc = io_uring_submit(&uring.ring);
+	if (rc < 0 && rc != -EINTR)
+		fprintf(stderr, "Failed to submit to io_uring: %s\n", strerror(-rc));
+
+	return rc;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Reap completed accesses
+ *
+ * Sets the result of every completed access to the number of transferred
+ * bytes or a negative errno. Waiting is resumed after signals.
+ *
+ * @param[out]  done	completed accesses
+ * @param[in]   max	maximum number of accesses to reap
+ * @param[in]   wait	wait for at least one completion
+ *
+ * @return number of reaped accesses, < 0 on error
+ *
+ ************************************************************************************/
+int piUringReap(struct pi_io **done, unsigned int max, bool wait)
+{
+	struct io_uring_cqe *cqe;
+	struct pi_io *io;
+	unsigned int n = 0;
+	int rc;
+
+	while (n < max) {
+		if (wait && n == 0)
+			rc = io_uring_wait_cqe(&uring.ring, &cqe);
+		else
+			rc = io_uring_peek_cqe(&uring.ring, &cqe);
+		if (rc == -EAGAIN)
+			break;
+		if (rc == -EINTR)
+			continue;
+		if (rc < 0) {
+			if (n)
+				break;
+			fprintf(stderr, "Failed to reap from io_uring: %s\n", strerror(-rc));
+			return rc;
+		}
+
+		io = io_uring_cqe_get_data(cqe);
+		io->result = cqe->res;
+		io_uring_cqe_seen(&uring.ring, cqe);
+		done[n++] = io;
+	}
+
+	return n;
+}
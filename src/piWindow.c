@@ -0,0 +1,202 @@
+// SPDX-FileCopyrightText: 2026 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+/*!
+ * Project: piTest
+ * Demo source code for usage of piControl driver
+ *
+ * \file piWindow.c
+ *
+ * \brief Windowed statistics of variables
+ *
+ * Variables, typically analog inputs, are sampled at a high rate and only
+ * the minimum, maximum, mean, standard deviation and RMS of each window are
+ * printed. The statistics are accumulated in constant memory with Welford's
+ * algorithm, so peaks between the printed lines are not lost.
+ */
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <errno.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "piControlIf.h"
+#include "piCycle.h"
+#include "piFormat.h"
+#include "piWindow.h"
+
+/******************************************************************************/
+/*******************************  Functions  **********************************/
+/******************************************************************************/
+
+void piWindowReset(struct pi_window_stat *st)
+{
+	memset(st, 0, sizeof(*st));
+	st->min = INT64_MAX;
+	st->max = INT64_MIN;
+}
+
+/* population standard deviation */
+double piWindowStddev(const struct pi_window_stat *st)
+{
+	return st->count ? sqrt(st->m2 / st->count) : 0;
+}
+
+double piWindowRms(const struct pi_window_stat *st)
+{
+	return st->count ? sqrt(st->sumsq / st->count) : 0;
+}
+
+static const char *const window_columns[] = {
+	"ts_ns", "variable", "samples", "min", "max", "mean", "stddev", "rms",
+};
+
+static void print_header(struct pi_format *fmt)
+{
+	unsigned int i;
+
+	if (fmt->type == PI_FORMAT_TEXT) {
+		piFormatPrintf(fmt, "%-17s %-32s %8s %11s %11s %14s %14s %14s\n", "time",
+			       "variable", "samples", "min", "max", "mean", "stddev", "rms");
+		return;
+	}
+
+	for (i = 0; i < sizeof(window_columns) / sizeof(window_columns[0]); i++)
+		piFormatName(fmt, window_columns[i]);
+	piFormatEnd(fmt);
+}
+
+/* print the statistics of a window, start is its wall clock time in ns */
+static void print_window(struct pi_format *fmt, uint64_t start, const struct pi_var *var,
+			 const struct pi_window_stat *st)
+{
+	if (fmt->type == PI_FORMAT_TEXT) {
+		piFormatPrintf(fmt, "%10" PRIu64 ".%06" PRIu64 " %-32s %8" PRIu64 " %11" PRId64
+			       " %11" PRId64 " %14.3f %14.3f %14.3f\n",
+			       start / 1000000000, (start % 1000000000) / 1000, var->name,
+			       st->count, st->min, st->max, st->mean, piWindowStddev(st),
+			       piWindowRms(st));
+		return;
+	}
+
+	piFormatKey(fmt, "ts_ns");
+	piFormatUint(fmt, start);
+	piFormatKey(fmt, "variable");
+	piFormatString(fmt, var->name);
+	piFormatKey(fmt, "samples");
+	piFormatUint(fmt, st->count);
+	piFormatKey(fmt, "min");
+	piFormatInt(fmt, st->min);
+	piFormatKey(fmt, "max");
+	piFormatInt(fmt, st->max);
+	piFormatKey(fmt, "mean");
+	piFormatDouble(fmt, "%.3f", st->mean);
+	piFormatKey(fmt, "stddev");
+	piFormatDouble(fmt, "%.3f", piWindowStddev(st));
+	piFormatKey(fmt, "rms");
+	piFormatDouble(fmt, "%.3f", piWindowRms(st));
+	piFormatEnd(fmt);
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Print windowed statistics of variables
+ *
+ * All variables are read with one read per period. At the end of each
+ * window a line with the statistics of every variable is printed.
+ *
+ * @param[in]   args	parameters of the statistics
+ *
+ * @return 0 on success, < 0 on error
+ *
+ ************************************************************************************/
+int piWindowRun(const struct pi_window_args *args)
+{
+	struct pi_var_table table = { 0 };
+	struct pi_window_stat *stats = NULL;
+	struct pi_format *fmt = NULL;
+	struct pi_cycle cycle;
+	struct pi_span span;
+	uint64_t window_ns = args->window_ms * 1000000ULL, start = 0, ts;
+	uint8_t *image = NULL;
+	int64_t wall_offset;
+	bool started = false;
+	unsigned int i;
+	int rc = 0;
+
+	rc = piFormatTextual(args->type);
+	if (rc < 0)
+		return rc;
+
+	for (i = 0; i < args->nvars && rc >= 0; i++)
+		rc = piVarTableAdd(&table, args->vars[i]);
+	if (rc < 0)
+		goto out;
+
+	piSpanInit(&span);
+	for (i = 0; i < table.count; i++)
+		piSpanAdd(&span, table.vars[i].offset, piImageVarBytes(&table.vars[i]));
+
+	image = malloc(span.length);
+	stats = malloc(table.count * sizeof(*stats));
+	fmt = malloc(sizeof(*fmt));
+	if (!image || !stats || !fmt) {
+		fprintf(stderr, "Not enough memory\n");
+		rc = -ENOMEM;
+		goto out;
+	}
+	for (i = 0; i < table.count; i++)
+		piWindowReset(&stats[i]);
+
+	piFormatInit(fmt, args->type, STDOUT_FILENO, NULL, 0);
+	print_header(fmt);
+	wall_offset = piImageWallclock() - piImageTimestamp();
+	rc = piCycleStart(&cycle, args->period_us);
+	if (rc < 0)
+		goto out;
+
+	do {
+		if (piControlRead(span.offset, span.length, image) < 0)
+			continue;
+		ts = piImageTimestamp();
+		if (!started) {
+			start = ts;
+			started = true;
+		}
+
+		/* the sample crossing the end of the window belongs to the next one */
+		if (ts - start >= window_ns) {
+			for (i = 0; i < table.count; i++) {
+				print_window(fmt, start + wall_offset, &table.vars[i], &stats[i]);
+				piWindowReset(&stats[i]);
+			}
+			rc = piFormatFlush(fmt);
+			if (rc < 0 || args->once)
+				break;
+			/* windows stay aligned to the first sample, empty ones are skipped */
+			start += (ts - start) / window_ns * window_ns;
+		}
+
+		for (i = 0; i < table.count; i++)
+			piWindowAdd(&stats[i], piImageValue(image, span.offset, &table.vars[i]));
+	} while (piCycleWait(&cycle));
+
+	piCycleFinish(&cycle);
+	if (piFormatFinish(fmt) < 0 && rc == 0)
+		rc = fmt->error;
+
+out:
+	free(fmt);
+	free(stats);
+	free(image);
+	piVarTableFree(&table);
+	return rc;
+}